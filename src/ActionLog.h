@@ -0,0 +1,138 @@
+// Compact log of actions taken by satellites in each iteration.
+// `Get(i)[j] == facility` if satellite `j` was transmitting data to station `facility`
+// (shifted by the number of satellites, as in `paired` arrays of solvers)
+// during iteration `i` and -1 otherwise.
+//
+// Consecutive iterations rarely differ, so for each iteration only the satellites
+// whose action changed are stored. Full rows (keyframes) are stored every
+// `KEYFRAME_INTERVAL` iterations to allow random access.
+class ActionLog {
+public:
+    // Action of a single satellite that differs from the previous iteration.
+    // Packed into 4 bytes, so both satellite and action indices must fit into 16 bits.
+    struct Change {
+        uint16_t satellite;
+        int16_t action;
+    };
+
+    // Sequential reader of the log, much faster than calling `Get` for each iteration.
+    class Cursor {
+    public:
+        Cursor() = default;
+        Cursor(const ActionLog* _log, int _iteration): log(_log), iteration(_iteration) {
+            if (iteration < log->Size()) {
+                row = log->Get(iteration);
+            }
+        }
+
+        // Actions of the current iteration.
+        const std::vector<int>& Row() const {
+            return row;
+        }
+
+        // Moves to the next iteration.
+        void Next() {
+            iteration++;
+            if (iteration < log->Size()) {
+                log->Apply(iteration, row);
+            }
+        }
+
+    private:
+        const ActionLog* log = nullptr;
+        int iteration = 0;
+        std::vector<int> row;
+    };
+
+    explicit ActionLog(int _satellites): satellites(_satellites), last(_satellites, -1) {}
+
+    // Appends actions of the next iteration.
+    void Append(const std::vector<int>& actions) {
+        assert((int) actions.size() == satellites && satellites <= UINT16_MAX);
+        if (Size() % KEYFRAME_INTERVAL == 0) {
+            keyframes.insert(keyframes.end(), actions.begin(), actions.end());
+        } else {
+            for (int i = 0; i < satellites; i++) {
+                if (actions[i] != last[i]) {
+                    assert(actions[i] <= INT16_MAX);
+                    changes.push_back(Change{uint16_t(i), int16_t(actions[i])});
+                }
+            }
+        }
+        offsets.push_back((int) changes.size());
+        last = actions;
+    }
+
+    // Appends `count` more iterations with the same actions as the last one.
+    void Repeat(int count) {
+        assert(Size() > 0);
+        for (; count > 0; count--) {
+            if (Size() % KEYFRAME_INTERVAL == 0) {
+                keyframes.insert(keyframes.end(), last.begin(), last.end());
+            }
+            offsets.push_back((int) changes.size());
+        }
+    }
+
+    // Returns the number of logged iterations.
+    int Size() const {
+        return (int) offsets.size() - 1;
+    }
+
+    // Returns actions of the given iteration.
+    std::vector<int> Get(int iteration) const {
+        assert(0 <= iteration && iteration < Size());
+        int keyframe = iteration / KEYFRAME_INTERVAL;
+        std::vector<int> row(keyframes.begin() + (long long) keyframe * satellites,
+            keyframes.begin() + (long long) (keyframe + 1) * satellites);
+        for (int i = keyframe * KEYFRAME_INTERVAL + 1; i <= iteration; i++) {
+            Apply(i, row);
+        }
+        return row;
+    }
+
+    // Returns the log of the first `iterations` iterations.
+    ActionLog Prefix(int iterations) const {
+        assert(0 <= iterations && iterations <= Size());
+        ActionLog result(satellites);
+        int keyframes_count = (iterations + KEYFRAME_INTERVAL - 1) / KEYFRAME_INTERVAL;
+        result.keyframes.assign(keyframes.begin(), keyframes.begin() + (long long) keyframes_count * satellites);
+        result.offsets.assign(offsets.begin(), offsets.begin() + iterations + 1);
+        result.changes.assign(changes.begin(), changes.begin() + result.offsets.back());
+        if (iterations > 0) {
+            result.last = Get(iterations - 1);
+        }
+        return result;
+    }
+
+    // Returns the approximate number of bytes used by the log.
+    size_t MemoryUsage() const {
+        return keyframes.capacity() * sizeof(int) + changes.capacity() * sizeof(Change)
+            + offsets.capacity() * sizeof(int) + last.capacity() * sizeof(int);
+    }
+
+private:
+    // Transforms actions of iteration `iteration - 1` into the actions of `iteration`.
+    void Apply(int iteration, std::vector<int>& row) const {
+        if (iteration % KEYFRAME_INTERVAL == 0) {
+            long long keyframe = iteration / KEYFRAME_INTERVAL;
+            copy(keyframes.begin() + keyframe * satellites, keyframes.begin() + (keyframe + 1) * satellites,
+                row.begin());
+            return;
+        }
+        for (int i = offsets[iteration]; i < offsets[iteration + 1]; i++) {
+            row[changes[i].satellite] = changes[i].action;
+        }
+    }
+
+    static const int KEYFRAME_INTERVAL = 1024;
+
+    int satellites = 0;
+    // Full rows of every `KEYFRAME_INTERVAL`-th iteration, concatenated.
+    std::vector<int> keyframes;
+    // Changes of iteration `i` are `changes[offsets[i]..offsets[i + 1])`.
+    std::vector<Change> changes;
+    std::vector<int> offsets = {0};
+    // Actions of the last appended iteration.
+    std::vector<int> last;
+};
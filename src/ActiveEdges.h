@@ -0,0 +1,42 @@
+// Maintains the set of facilities currently visible from each satellite.
+// Sets are stored as bitsets, so insertion and removal take O(1)
+// and facilities are always enumerated in the increasing order
+// (the same order as a full scan over all facilities would produce).
+class ActiveEdges {
+public:
+    ActiveEdges(int _satellites, int _facilities):
+        words((_facilities + 63) / 64), bits(size_t(_satellites) * words) {}
+
+    void Insert(int satellite, int facility) {
+        bits[size_t(satellite) * words + facility / 64] |= uint64_t(1) << (facility % 64);
+    }
+
+    void Remove(int satellite, int facility) {
+        bits[size_t(satellite) * words + facility / 64] &= ~(uint64_t(1) << (facility % 64));
+    }
+
+    bool Contains(int satellite, int facility) const {
+        return (bits[size_t(satellite) * words + facility / 64] >> (facility % 64)) & 1;
+    }
+
+    // Returns all facilities visible from `satellite` as a bitmask.
+    // Requires at most 64 facilities.
+    uint64_t Mask(int satellite) const {
+        assert(words <= 1);
+        return words == 0 ? 0 : bits[satellite];
+    }
+
+    // Replaces `adjacent` with all facilities visible from `satellite`, each shifted by `offset`.
+    void Collect(int satellite, int offset, std::vector<int>& adjacent) const {
+        adjacent.clear();
+        for (int w = 0; w < words; w++) {
+            for (uint64_t mask = bits[size_t(satellite) * words + w]; mask != 0; mask &= mask - 1) {
+                adjacent.push_back(offset + w * 64 + __builtin_ctzll(mask));
+            }
+        }
+    }
+
+private:
+    int words;
+    std::vector<uint64_t> bits;
+};
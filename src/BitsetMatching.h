@@ -0,0 +1,92 @@
+// Weighted Kuhn's algorithm for graphs with at most `MAX_FACILITIES` facilities.
+// Facilities available for each satellite are given as a bitmask, so alternating paths
+// are searched with bit operations instead of iterating over adjacency lists.
+//
+// Produces exactly the same matching as Kuhn's algorithm of the solvers: facilities
+// are still tried in the increasing order. Facilities whose owners were already visited
+// in the current phase are excluded from the masks, the DFS would fail on them anyway.
+template <int MAX_FACILITIES>
+class BitsetMatching {
+public:
+    static_assert(0 < MAX_FACILITIES && MAX_FACILITIES <= 64, "facilities must fit into a 64-bit mask");
+
+    // The smallest unsigned type fitting all facilities.
+    using Mask = std::conditional_t<MAX_FACILITIES <= 16, uint16_t,
+        std::conditional_t<MAX_FACILITIES <= 32, uint32_t, uint64_t>>;
+
+    explicit BitsetMatching(int _satellites): satellites(_satellites), matched(_satellites), used(_satellites) {}
+
+    // Runs Kuhn's algorithm using `perm` order.
+    // `adjacent[i]` has bit `f` set if satellite `i` can transmit data to facility `f`.
+    // Returns `paired` array: `paired[i]` is the facility (shifted by `satellites`) matched
+    // to satellite `i` or -1 otherwise.
+    std::vector<int> Run(int facilities, const std::vector<uint64_t>& _adjacent, const std::vector<int>& perm) {
+        assert(facilities <= MAX_FACILITIES && (int) _adjacent.size() == satellites);
+        adjacent = _adjacent.data();
+        owner.fill(-1);
+        fill(matched.begin(), matched.end(), -1);
+        free = Mask(facilities == 64 ? ~uint64_t(0) : (uint64_t(1) << facilities) - 1);
+        for (bool run = true; run && free != 0;) {
+            run = false;
+            blocked = 0;
+            fill(used.begin(), used.end(), 0);
+            for (int i = 0; i < satellites && free != 0; i++) {
+                int v = perm[i];
+                if (!used[v] && matched[v] == -1 && (Mask(adjacent[v]) & ~blocked) != 0 && RunDfs(v)) {
+                    run = true;
+                }
+            }
+        }
+        std::vector<int> paired(satellites, -1);
+        for (int i = 0; i < satellites; i++) {
+            if (matched[i] != -1) {
+                paired[i] = satellites + matched[i];
+            }
+        }
+        return paired;
+    }
+
+    // Returns the number of satellites whose edges were scanned so far.
+    // `RunDfs` is never called for the visited satellite, so it's the number of its calls.
+    long long Expansions() const {
+        return expansions;
+    }
+
+private:
+    // Returns true if chain could be extended.
+    bool RunDfs(int v) {
+        expansions++;
+        used[v] = 1;
+        if (matched[v] != -1) {
+            blocked |= Mask(1) << matched[v];
+        }
+        // `blocked` only grows during the phase, so bits removed from `candidates` never come back.
+        for (Mask candidates = Mask(adjacent[v]) & ~blocked; candidates != 0; candidates &= ~blocked) {
+            int to = __builtin_ctzll(candidates);
+            candidates &= candidates - 1;
+            int previous = owner[to];
+            if (previous == -1 || RunDfs(previous)) {
+                if (previous == -1) {
+                    free &= ~(Mask(1) << to);
+                }
+                owner[to] = v, matched[v] = to;
+                blocked |= Mask(1) << to;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    int satellites;
+    const uint64_t* adjacent = nullptr;
+    // Facility matched to each satellite or -1.
+    std::vector<int> matched;
+    // Satellite matched to each facility or -1.
+    std::array<int, MAX_FACILITIES> owner;
+    std::vector<char> used;
+    // Facilities without the matched satellite.
+    Mask free = 0;
+    // Facilities whose matched satellites are already visited in the current phase.
+    Mask blocked = 0;
+    long long expansions = 0;
+};
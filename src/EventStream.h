@@ -0,0 +1,229 @@
+// Start or end of the visibility segment.
+struct Event {
+    // Timestamp.
+    long long x = 0;
+    // End timestamp.
+    long long end_x = 0;
+    // 1 stands for the start of interval, 0 stands for the end of interval.
+    int type = 0;
+    // Index of facility for (satellite, facility) visibility intervals.
+    // -1 otherwise.
+    int facility;
+    // Index of satellite for both (satellite, facility) and satellite visibility intervals.
+    int satellite;
+
+    bool operator<(const Event& other) const {
+        if (x != other.x) {
+            return x < other.x;
+        }
+        if (type != other.type) {
+            return type < other.type;
+        }
+        if (facility != other.facility) {
+            return facility < other.facility;
+        }
+        return satellite < other.satellite;
+    }
+};
+
+// Event packed into 16 bytes.
+// `key` contains (starting from the highest bits) 32-bit offset of the timestamp in millis
+// from the horizon start, type bit, 15-bit facility index shifted by one (so -1 becomes 0)
+// and 16-bit satellite index, so keys are ordered the same way as `Event`s.
+// End timestamps are not stored, `segment` is the index of the segment in `VisibilityStore::All()`.
+struct PackedEvent {
+    uint64_t key;
+    uint32_t segment;
+};
+static_assert(sizeof(PackedEvent) == 16);
+
+namespace {
+
+// Sorts events by `key` using LSD radix sort with 16-bit digits.
+// Digits that are the same for all events are skipped.
+void RadixSort(std::vector<PackedEvent>& events) {
+    const int DIGIT_BITS = 16;
+    const int DIGITS = 64 / DIGIT_BITS;
+    const uint64_t DIGIT_MASK = (uint64_t(1) << DIGIT_BITS) - 1;
+    std::vector<size_t> counts(DIGITS << DIGIT_BITS);
+    for (const auto& event : events) {
+        for (int d = 0; d < DIGITS; d++) {
+            counts[(d << DIGIT_BITS) | ((event.key >> (d * DIGIT_BITS)) & DIGIT_MASK)]++;
+        }
+    }
+    std::vector<PackedEvent> buffer(events.size());
+    for (int d = 0; d < DIGITS && !events.empty(); d++) {
+        size_t* digit_counts = counts.data() + (d << DIGIT_BITS);
+        if (digit_counts[(events[0].key >> (d * DIGIT_BITS)) & DIGIT_MASK] == events.size()) {
+            continue;
+        }
+        size_t position = 0;
+        for (size_t digit = 0; digit <= DIGIT_MASK; digit++) {
+            size_t count = digit_counts[digit];
+            digit_counts[digit] = position;
+            position += count;
+        }
+        for (const auto& event : events) {
+            buffer[digit_counts[(event.key >> (d * DIGIT_BITS)) & DIGIT_MASK]++] = event;
+        }
+        events.swap(buffer);
+    }
+}
+
+}
+
+// Produces events of all visibility segments in the sorted order.
+//
+// By default all events are materialized as `PackedEvent`s and sorted with `RadixSort`.
+// Segment lists of `VisibilityStore` are already sorted, so alternatively they are lazily
+// k-way merged through a heap which contains the next start of every list and the ends of
+// all currently open segments. The end of a segment is added only once its start is produced,
+// so the memory stays O(F * S) instead of O(total segments). Merging is also used when
+// the horizon doesn't fit into the packed event (about 49 days).
+class EventStream {
+public:
+    enum class Source {
+        SORTED,
+        MERGED,
+    };
+
+    explicit EventStream(const VisibilityStore& _visibility, Source _source = Source::SORTED):
+        visibility(_visibility), all(visibility.All()), source(_source) {
+        long long start = std::numeric_limits<long long>::max();
+        long long end = 0;
+        for (int i = 0; i < all.size(); i++) {
+            start = std::min(start, all.l[i]);
+            end = std::max(end, all.r[i]);
+        }
+        if (source == Source::SORTED && (end - start > (long long) UINT32_MAX
+            || visibility.Facilities() >= (1 << 15) || visibility.Satellites() > UINT16_MAX)) {
+            source = Source::MERGED;
+        }
+        if (source == Source::SORTED) {
+            horizon_start = start;
+            Materialize();
+        } else {
+            positions.resize((visibility.Facilities() + 1) * visibility.Satellites());
+            for (int i = 0; i < visibility.Facilities(); i++) {
+                for (int j = 0; j < visibility.Satellites(); j++) {
+                    PushStart(i, j);
+                }
+            }
+            for (int j = 0; j < visibility.Satellites(); j++) {
+                PushStart(-1, j);
+            }
+        }
+    }
+
+    bool Empty() const {
+        return source == Source::SORTED ? consumed == (long long) packed.size() : heap.empty();
+    }
+
+    // Returns the next event without consuming it.
+    const Event& Peek() const {
+        return source == Source::SORTED ? front : heap.front();
+    }
+
+    // Consumes the next event.
+    Event Pop() {
+        if (source == Source::SORTED) {
+            Event event = front;
+            consumed++;
+            Unpack();
+            return event;
+        }
+        std::pop_heap(heap.begin(), heap.end(), Later);
+        Event event = heap.back();
+        heap.pop_back();
+        consumed++;
+        if (event.type) {
+            Push(Event{.x = event.end_x, .type = 0, .facility = event.facility, .satellite = event.satellite});
+            PushStart(event.facility, event.satellite);
+        }
+        return event;
+    }
+
+    // Returns the number of consumed events.
+    long long Consumed() const {
+        return consumed;
+    }
+
+    // Returns the total number of events.
+    long long Size() const {
+        return 2ll * all.size();
+    }
+
+private:
+    // Creates packed events of all segments and sorts them.
+    void Materialize() {
+        packed.reserve(Size());
+        auto add_events = [this](SegmentsView segments, int facility, int satellite) {
+            uint64_t ids = (uint64_t(facility + 1) << 16) | uint64_t(satellite);
+            uint32_t first = uint32_t(segments.l - all.l);
+            for (int k = 0; k < segments.size(); k++) {
+                packed.push_back(PackedEvent{(uint64_t(segments.l[k] - horizon_start) << 32)
+                    | (uint64_t(1) << 31) | ids, first + k});
+                packed.push_back(PackedEvent{(uint64_t(segments.r[k] - horizon_start) << 32) | ids, first + k});
+            }
+        };
+        for (int i = 0; i < visibility.Facilities(); i++) {
+            for (int j = 0; j < visibility.Satellites(); j++) {
+                add_events(visibility.Facility(i, j), i, j);
+            }
+        }
+        for (int j = 0; j < visibility.Satellites(); j++) {
+            add_events(visibility.Satellite(j), -1, j);
+        }
+        RadixSort(packed);
+        Unpack();
+    }
+
+    // Decodes the next packed event into `front`.
+    void Unpack() {
+        if (consumed == (long long) packed.size()) {
+            return;
+        }
+        const PackedEvent& event = packed[consumed];
+        front.x = horizon_start + (long long) (event.key >> 32);
+        front.type = (event.key >> 31) & 1;
+        front.end_x = front.type ? all.r[event.segment] : 0;
+        front.facility = int((event.key >> 16) & ((1 << 15) - 1)) - 1;
+        front.satellite = int(event.key & ((1 << 16) - 1));
+    }
+
+    // Heap comparator, the earliest event should be on top.
+    static bool Later(const Event& a, const Event& b) {
+        return b < a;
+    }
+
+    void Push(const Event& event) {
+        heap.push_back(event);
+        std::push_heap(heap.begin(), heap.end(), Later);
+    }
+
+    // Adds the start of the next segment of the given list to the heap if there is one.
+    void PushStart(int facility, int satellite) {
+        SegmentsView segments = facility == -1 ? visibility.Satellite(satellite)
+            : visibility.Facility(facility, satellite);
+        int& position = positions[(facility == -1 ? visibility.Facilities() : facility)
+            * visibility.Satellites() + satellite];
+        if (position < segments.size()) {
+            Push(Event{.x = segments.l[position], .end_x = segments.r[position], .type = 1,
+                .facility = facility, .satellite = satellite});
+            position++;
+        }
+    }
+
+    const VisibilityStore& visibility;
+    SegmentsView all;
+    Source source;
+    long long consumed = 0;
+    // State of `Source::SORTED`.
+    long long horizon_start = 0;
+    std::vector<PackedEvent> packed;
+    Event front;
+    // State of `Source::MERGED`.
+    // Index of the next segment to be started in each list (in the `VisibilityStore` list order).
+    std::vector<int> positions;
+    std::vector<Event> heap;
+};
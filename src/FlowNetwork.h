@@ -0,0 +1,169 @@
+// Directed network with capacities and costs per unit of flow on the edges.
+// Supports maximum flow (Dinic's algorithm) and maximum profit flow (primal-dual algorithm
+// which runs Dinic's algorithm on the shortest paths).
+//
+// Edges are stored in pairs: edge `e` and its reverse edge `e ^ 1` with the negated cost,
+// adjacency lists are linked lists over the edge arrays to keep large networks compact.
+// All searches are iterative, so long paths (e.g. in time-expanded networks) are fine.
+class FlowNetwork {
+public:
+    explicit FlowNetwork(int _nodes = 0): head(_nodes, -1) {}
+
+    int AddNode() {
+        head.push_back(-1);
+        return (int) head.size() - 1;
+    }
+
+    int Nodes() const {
+        return (int) head.size();
+    }
+
+    // Adds edge with the given capacity and cost per unit of flow, returns its index.
+    int AddEdge(int from, int to, long long capacity, long long cost = 0) {
+        assert(0 <= from && from < Nodes() && 0 <= to && to < Nodes() && capacity >= 0);
+        int edge = (int) edges.size();
+        edges.push_back(Edge{to, head[from], capacity, cost});
+        head[from] = edge;
+        edges.push_back(Edge{from, head[to], 0, -cost});
+        head[to] = edge + 1;
+        return edge;
+    }
+
+    // Returns the flow sent through the edge.
+    long long Flow(int edge) const {
+        return edges[edge ^ 1].capacity;
+    }
+
+    // Sends the maximum flow from `source` to `sink`, returns its value.
+    long long MaxFlow(int source, int sink) {
+        return RunDinic(source, sink, [](int) { return true; });
+    }
+
+    // Sends flow from `source` to `sink` along the cheapest paths while their cost is negative,
+    // so the total cost is minimized (the profit is maximized). Returns the total cost.
+    // `potential` should make all reduced costs `cost + potential[from] - potential[to]`
+    // of edges with positive capacity non-negative.
+    long long MinCostFlow(int source, int sink, std::vector<long long> potential) {
+        assert((int) potential.size() == Nodes());
+        const long long INF = std::numeric_limits<long long>::max();
+        auto reduced_cost = [&](int edge) {
+            return edges[edge].cost + potential[edges[edge ^ 1].to] - potential[edges[edge].to];
+        };
+        long long total_cost = 0;
+        std::vector<long long> distance(Nodes());
+        while (true) {
+            // Dijkstra's algorithm on reduced costs.
+            fill(distance.begin(), distance.end(), INF);
+            std::priority_queue<std::pair<long long, int>, std::vector<std::pair<long long, int>>,
+                std::greater<>> queue;
+            distance[source] = 0;
+            queue.emplace(0, source);
+            while (!queue.empty()) {
+                auto [d, v] = queue.top();
+                queue.pop();
+                if (d != distance[v]) {
+                    continue;
+                }
+                for (int e = head[v]; e != -1; e = edges[e].next) {
+                    if (edges[e].capacity > 0 && d + reduced_cost(e) < distance[edges[e].to]) {
+                        distance[edges[e].to] = d + reduced_cost(e);
+                        queue.emplace(distance[edges[e].to], edges[e].to);
+                    }
+                }
+            }
+            if (distance[sink] == INF || distance[sink] + potential[sink] - potential[source] >= 0) {
+                break;
+            }
+            // Nodes farther than the sink are never on the shortest paths, capping keeps costs valid.
+            for (int v = 0; v < Nodes(); v++) {
+                potential[v] += std::min(distance[v], distance[sink]);
+            }
+            long long path_cost = potential[sink] - potential[source];
+            total_cost += path_cost * RunDinic(source, sink, [&](int edge) { return reduced_cost(edge) == 0; });
+        }
+        return total_cost;
+    }
+
+private:
+    // Integer fields go first to keep the edge 24 bytes long.
+    struct Edge {
+        int to;
+        // Next edge from the same node or -1.
+        int next;
+        // Residual capacity.
+        long long capacity;
+        long long cost;
+    };
+
+    // Runs Dinic's algorithm using only edges satisfying `allowed`.
+    template <class Allowed>
+    long long RunDinic(int source, int sink, const Allowed& allowed) {
+        long long total_flow = 0;
+        std::vector<int> level(Nodes());
+        std::vector<int> current(Nodes());
+        std::vector<int> queue;
+        std::vector<int> path;
+        while (true) {
+            fill(level.begin(), level.end(), -1);
+            level[source] = 0;
+            queue.assign(1, source);
+            for (size_t i = 0; i < queue.size() && level[sink] == -1; i++) {
+                int v = queue[i];
+                for (int e = head[v]; e != -1; e = edges[e].next) {
+                    if (edges[e].capacity > 0 && level[edges[e].to] == -1 && allowed(e)) {
+                        level[edges[e].to] = level[v] + 1;
+                        queue.push_back(edges[e].to);
+                    }
+                }
+            }
+            if (level[sink] == -1) {
+                return total_flow;
+            }
+            current = head;
+            // Blocking flow: `path` contains edges from `source` to the current node.
+            path.clear();
+            int v = source;
+            while (true) {
+                if (v == sink) {
+                    long long flow = std::numeric_limits<long long>::max();
+                    for (int e : path) {
+                        flow = std::min(flow, edges[e].capacity);
+                    }
+                    total_flow += flow;
+                    // Return to the tail of the first saturated edge.
+                    int first_saturated = -1;
+                    for (int i = 0; i < (int) path.size(); i++) {
+                        edges[path[i]].capacity -= flow;
+                        edges[path[i] ^ 1].capacity += flow;
+                        if (first_saturated == -1 && edges[path[i]].capacity == 0) {
+                            first_saturated = i;
+                        }
+                    }
+                    path.resize(first_saturated);
+                    v = path.empty() ? source : edges[path.back()].to;
+                    continue;
+                }
+                int& e = current[v];
+                while (e != -1 && (edges[e].capacity == 0 || level[edges[e].to] != level[v] + 1 || !allowed(e))) {
+                    e = edges[e].next;
+                }
+                if (e != -1) {
+                    path.push_back(e);
+                    v = edges[e].to;
+                    continue;
+                }
+                // Dead end, never visit this node again during the phase.
+                level[v] = -1;
+                if (path.empty()) {
+                    break;
+                }
+                path.pop_back();
+                v = path.empty() ? source : edges[path.back()].to;
+                current[v] = edges[current[v]].next;
+            }
+        }
+    }
+
+    std::vector<int> head;
+    std::vector<Edge> edges;
+};
@@ -1,58 +1,55 @@
+// Parameters of the heuristics of `GreedyEventBasedSolver`.
+// Defaults are the best values determined during tests, see `SolverTuner` to retune them.
+struct GreedyEventBasedSolverOptions {
+    // Satellite which is able to do photoshooting transmits data only if its disk
+    // is filled at least by this ratio.
+    double space_used_ratio = 0.93;
+    // Assignments are kept for at least this number of millis (unless the current segment ends earlier).
+    long long min_segment_length = 1000;
+    // Satellite never transmits data if it has less than it transmits in this number of millis.
+    long long min_transmission_length = 5;
+    // Records actions and checkpoints of the result, which are needed only to resume solving from it
+    // (e.g. by the local search). Disabling it together with `ScheduleSink` keeps the memory used
+    // by the solver independent of the length of the horizon.
+    bool record_actions = true;
+};
+
 // The main solver combining different ideas:
-// 1. Sorting all events (starts and ends of visibility intervals) and solving 
+// 1. Processing all events (starts and ends of visibility intervals) in the sorted order and solving 
 //    each segment without changing any assingments inside it.
 // 2. Weighted Kuhn's algorithm to calculate perfect matching between stations and satellites.
 // 3. Greedily assigning remaining satellites to do photoshooting.
 // 4. Some other heuristics used across the code.
+//
+// If `ScheduleSink` is given, finalized segments are pushed to it during solving instead of
+// being stored in the result, so the result has only `total_data`, actions and checkpoints
+// (unless `record_actions` is disabled) and can't be used as `previous_result`.
 class GreedyEventBasedSolver : public Solver {
 public:
+    // Algorithm used to match satellites with facilities in each iteration.
+    enum class Matching {
+        // Runs weighted Kuhn's algorithm from scratch.
+        // Uses `BitsetMatching` if there are at most 64 facilities and falls back to `KUHN_LISTS` otherwise.
+        KUHN,
+        // Runs weighted Kuhn's algorithm from scratch on adjacency lists.
+        KUHN_LISTS,
+        // Updates the matching from the previous iteration, see `IncrementalMatching`.
+        INCREMENTAL,
+    };
+
+    explicit GreedyEventBasedSolver(Matching _matching = Matching::KUHN,
+        const GreedyEventBasedSolverOptions& _options = {}, ScheduleSink* _sink = nullptr):
+        matching(_matching), options(_options), sink(_sink) {}
+
     TransmissionResult GetTransmissionSchedule(
-        const std::vector<std::vector<std::vector<Segment>>>& facility_visibility,
-        const std::vector<std::vector<Segment>>& satellite_visibility,
+        const VisibilityStore& visibility,
         const std::vector<SatelliteType>& satellite_types,
-        const std::vector<std::vector<int>>& precalculated_actions,
+        const TransmissionResult* previous_result = nullptr,
         int selected_iteration = -1) override {
-        struct Event {
-            // Timestamp.
-            long long x = 0;
-            // End timestamp.
-            long long end_x = 0;
-            // 1 stands for the start of interval, 0 stands for the end of interval.
-            int type = 0;
-            // Index of facility for (satellite, facility) visibility intervals.
-            // -1 otherwise. 
-            int facility;
-            // Index of satellite for both (satellite, facility) and satellite visibility intervals.
-            int satellite;
-
-            bool operator<(const Event& other) const {
-                if (x != other.x) {
-                    return x < other.x;
-                }
-                return std::make_tuple(type, facility, satellite) 
-                    < std::make_tuple(other.type, other.facility, other.satellite);
-            }
-        };
-
-        // Collect all the events of visibility segment start / end and sort them.
-        std::vector<Event> events;
-        int facilities = (int) facility_visibility.size();
-        int satellites = (int) facility_visibility[0].size();
-        for (int i = 0; i < facilities; i++) {
-            for (int j = 0; j < satellites; j++) {
-                for (const auto& segment : facility_visibility[i][j]) {
-                    events.push_back(Event{.x = segment.l, .end_x = segment.r, .type = 1, .facility = i, .satellite = j});
-                    events.push_back(Event{.x = segment.r, .type = 0, .facility = i, .satellite = j});
-                }                
-            }
-        }
-        for (int i = 0; i < satellites; i++) {
-            for (const auto& segment : satellite_visibility[i]) {
-                events.push_back(Event{.x = segment.l, .end_x = segment.r, .type = 1, .facility = -1, .satellite = i});
-                events.push_back(Event{.x = segment.r, .type = 0, .facility = -1, .satellite = i});
-            }
-        }
-        sort(events.begin(), events.end());
+        // All the events of visibility segment start / end in the sorted order.
+        EventStream events(visibility);
+        int facilities = visibility.Facilities();
+        int satellites = visibility.Satellites();
 
         // Inserts segments to vector and potentially merges it with the previous one.
         auto insert_segment = [](std::vector<Segment>& segments, const Segment& segment) {
@@ -69,73 +66,193 @@ public:
         // All facilities that are available for given satellite 
         // for data transmission during given iteration.
         std::vector<std::vector<int>> graph(satellites);
+        // The same edges as bitmasks of facilities, used instead of `graph` by `BitsetMatching`.
+        bool use_bitset = matching == Matching::KUHN && 0 < facilities && facilities <= 64;
+        std::vector<uint64_t> adjacent(satellites);
         // Stores the end of time period when satellite is visible or 0 otherwise.
         std::vector<long long> satellite_visible(satellites);
-        // Stores 1 when satellite is visible from given facility or 0 otherwise.
-        std::vector<std::vector<int>> facility_satellite_visible(facilities, std::vector<int>(satellites));
+        // Stores facilities from which each satellite is currently visible.
+        ActiveEdges facility_satellite_visible(satellites, facilities);
+        // Satellites whose visibility or disk space changed since `graph` was built for them.
+        // Only these satellites need to have their edges reevaluated.
+        std::vector<int> changed_satellites(satellites);
+        iota(changed_satellites.begin(), changed_satellites.end(), 0);
+        std::vector<int> changed(satellites, 1);
+        auto mark_changed = [&changed, &changed_satellites](int satellite) {
+            if (!changed[satellite]) {
+                changed[satellite] = 1;
+                changed_satellites.push_back(satellite);
+            }
+        };
         
+        // Updates visibility state according to the given event.
+        auto apply_event = [&](const Event& event) {
+            if (event.facility == -1) {
+                satellite_visible[event.satellite] = event.type ? event.end_x : 0;
+            } else if (event.type) {
+                facility_satellite_visible.Insert(event.satellite, event.facility);
+            } else {
+                facility_satellite_visible.Remove(event.satellite, event.facility);
+            }
+        };
+        
+        // Indicates if actions from `previous_result` should be used 
+        // or if the new greedy assignment should be recalculated.
+        bool recalculate = previous_result == nullptr;
+        // How often (in iterations) the solver state is saved to `result.checkpoints`.
+        const int CHECKPOINT_INTERVAL = 10000;
         TransmissionResult result(facilities, satellites);
-        const double SPACE_USED_RATIO = 0.93;
-        long long current_time = events[0].x;
-        for (int it = 0; it < (int) events.size();) {
-            while (it < (int) events.size() && events[it].x == current_time) {
-                if (events[it].facility == -1) {
-                    satellite_visible[events[it].satellite] = events[it].type ? events[it].end_x : 0;
-                } else {
-                    facility_satellite_visible[events[it].facility][events[it].satellite] = events[it].type;
+        long long current_time = events.Empty() ? 0 : events.Peek().x;
+        // Reads actions of `previous_result` starting from the restored iteration.
+        ActionLog::Cursor replayed_actions;
+        if (!recalculate) {
+            // Resume from the latest checkpoint before the selected iteration 
+            // instead of replaying all the previous actions.
+            // Visibility state is restored by applying all the preceding events which is much 
+            // cheaper than replaying the iterations.
+            if (const SolverCheckpoint* checkpoint = previous_result->FindCheckpoint(selected_iteration)) {
+                result.RestoreCheckpoint(*previous_result, *checkpoint);
+                space_used = checkpoint->space_used;
+                current_time = checkpoint->time;
+                while (events.Consumed() < checkpoint->positions[0]) {
+                    apply_event(events.Pop());
                 }
-                it++;
             }
-            if (it == (int) events.size()) {
-                break;
+            replayed_actions = ActionLog::Cursor(&previous_result->actions, result.actions.Size());
+        }
+        // The last segment of each satellite which could still be extended if `sink` is used.
+        // Transmission to `facility` or photoshooting if `facility` is -1.
+        struct OpenSegment {
+            int facility = -1;
+            Segment segment = Segment(0, 0);
+        };
+        assert(sink == nullptr || previous_result == nullptr);
+        std::vector<OpenSegment> open_segments(sink == nullptr ? 0 : satellites);
+        if (sink != nullptr) {
+            sink->Begin(facilities, satellites);
+        }
+        // Adds segment of satellite `i` to the result or to the sink once it's finalized.
+        auto add_segment = [&](int facility, int i, const Segment& segment) {
+            if (sink == nullptr) {
+                insert_segment(facility == -1 ? result.shooting_segments[i]
+                    : result.transmission_segments[facility][i], segment);
+                return;
             }
-            // Currently considered segment.
-            Segment current(current_time, events[it].x);
-            if (it % 1000 == 0) {
-                std::cerr << "Progress: " << round(it * 100. / (int) events.size()) << "%\n";
+            OpenSegment& open = open_segments[i];
+            if (open.segment.Length() > 0 && open.facility == facility && open.segment.r == segment.l) {
+                open.segment.r = segment.r;
+                return;
+            }
+            if (open.segment.Length() > 0) {
+                sink->Push(open.facility, i, open.segment);
             }
+            open = OpenSegment{facility, segment};
+        };
 
-            for (int i = 0; i < satellites; i++) {
-                graph[i].clear();
+        IncrementalMatching incremental_matching(satellites, facilities);
+        BitsetMatching<16> bitset_matching_16(satellites);
+        BitsetMatching<64> bitset_matching_64(satellites);
+        matching_expansions = 0;
+        int iteration = result.actions.Size();
+        for (; !events.Empty(); iteration++) {
+            if (options.record_actions && iteration % CHECKPOINT_INTERVAL == 0) {
+                SolverCheckpoint checkpoint = result.MakeCheckpoint(iteration);
+                checkpoint.time = current_time;
+                checkpoint.space_used = space_used;
+                checkpoint.positions = {(int) events.Consumed()};
+                result.checkpoints.push_back(std::move(checkpoint));
+            }
+            while (!events.Empty() && events.Peek().x == current_time) {
+                Event event = events.Pop();
+                apply_event(event);
+                mark_changed(event.satellite);
+            }
+            if (events.Empty()) {
+                break;
+            }
+            // Currently considered segment.
+            Segment current(current_time, events.Peek().x);
+            if (events.Consumed() % 1000 == 0) {
+                std::cerr << "Progress: " << round(events.Consumed() * 100. / events.Size()) << "%\n";
             }
 
-            for (int i = 0; i < facilities; i++) {
-                for (int j = 0; j < satellites; j++) {
-                    if (facility_satellite_visible[i][j]) {
-                        // Never try to transmit any data from satellite with small amount of data.
-                        if (space_used[j] < satellite_types[j].freeing_speed * 5) {
-                            continue;
+            std::vector<int> paired;
+            if (recalculate) {
+                // Reevaluate edges only for satellites whose state changed.
+                // While actions are replayed, changed satellites are accumulated 
+                // and their edges are evaluated after the mutation.
+                for (int j : changed_satellites) {
+                    changed[j] = 0;
+                    // Never try to transmit any data from satellite with small amount of data.
+                    // Create an edge between satellite and facility only 
+                    // if satellite is unable to do photoshooting 
+                    // or if it's getting out of space.
+                    if (space_used[j] >= satellite_types[j].freeing_speed * options.min_transmission_length
+                        && (!satellite_visible[j] || double(space_used[j]) * 0.001 / double(satellite_types[j].space)
+                        >= options.space_used_ratio)) {
+                        if (use_bitset) {
+                            adjacent[j] = facility_satellite_visible.Mask(j);
+                        } else {
+                            facility_satellite_visible.Collect(j, satellites, graph[j]);
                         }
-                        // Create an edge between satellite and facility only 
-                        // if satellite is unable to do photoshooting 
-                        // or if it's getting out of space.
-                        // `SPACE_USED_RATIO` is assigned to the best value 
-                        // determined during tests.
-                        if (!satellite_visible[j] 
-                            || double(space_used[j]) * 0.001 / double(satellite_types[j].space) >= SPACE_USED_RATIO) {
-                            graph[j].push_back(satellites + i);
+                    } else {
+                        graph[j].clear();
+                        adjacent[j] = 0;
+                    }
+                }
+                changed_satellites.clear();
+
+                // Weighted Kuhn's algorithm implementation.
+                // All satellites are ordered by their cost in the descending order.
+                // The less time is needed to fully occupy satellite's disk space the bigger is cost.
+                // The faster satellite transmits its data back to Earth, the bigger is cost.
+                // This allows to free up the most critical satellites efficiently.
+                std::vector<double> cost(satellites);
+                for (int i = 0; i < satellites; i++) {
+                    cost[i] = GetCost(space_used[i], 
+                        satellite_visible[i] == 0 ? 0 : satellite_visible[i] - current_time,
+                        satellite_types[i]);
+                }
+                std::vector<int> perm(satellites);
+                iota(perm.begin(), perm.end(), 0);
+                sort(perm.begin(), perm.end(), [&](int i, int j) { return cost[i] > cost[j]; });
+                
+                if (use_bitset && facilities <= 16) {
+                    paired = bitset_matching_16.Run(facilities, adjacent, perm);
+                } else if (use_bitset) {
+                    paired = bitset_matching_64.Run(facilities, adjacent, perm);
+                } else if (matching != Matching::INCREMENTAL) {
+                    paired = RunKuhn(facilities, satellites, graph, perm);
+                } else {
+                    paired = incremental_matching.Update(graph, perm);
+                    paired.resize(satellites);
+                }
+            } else {
+                // Reuse action from the previous step.
+                paired = replayed_actions.Row();
+                replayed_actions.Next();
+                if (iteration == selected_iteration) {
+                    bool changed = false;
+                    // Try to unassign from transmission the first satellite 
+                    // that could do a photoshooting instead.
+                    for (int i = 0; i < satellites; i++) {
+                        if (paired[i] != -1 && space_used[i] < satellite_types[i].space * 1000
+                            && satellite_visible[i] - current_time > options.min_segment_length) {
+                            paired[i] = -1;
+                            changed = true;
+                            break;
                         }
                     }
+                    // If the mutation didn't change anything, there is no need to continue,
+                    // the schedule is going to be the same as the previous one.
+                    if (!changed) {
+                        return *previous_result;
+                    }
+                    // Use greedy algorithm going forward.
+                    recalculate = true;
                 }
             }
 
-            // Weighted Kuhn's algorithm implementation.
-            // All satellites are ordered by their cost in the descending order.
-            // The less time is needed to fully occupy satellite's disk space the bigger is cost.
-            // The faster satellite transmits its data back to Earth, the bigger is cost.
-            // This allows to free up the most critical satellites efficiently.
-            std::vector<double> cost(satellites);
-            for (int i = 0; i < satellites; i++) {
-                cost[i] = GetCost(space_used[i], 
-                    satellite_visible[i] == 0 ? 0 : satellite_visible[i] - current_time,
-                    satellite_types[i]);
-            }
-            std::vector<int> perm(satellites);
-            iota(perm.begin(), perm.end(), 0);
-            sort(perm.begin(), perm.end(), [&](int i, int j) { return cost[i] > cost[j]; });
-            
-            std::vector<int> paired = RunKuhn(facilities, satellites, graph, perm);
-
             // Not the entire segment has to have the same assignment.
             // Change assignment once any of ongoing events finishes.
             long long min_duration = current.Length();
@@ -155,8 +272,7 @@ public:
                     }
                 }
             }
-            const long long MIN_SEGMENT_LENGTH = 1000;
-            min_duration = std::max(min_duration, std::min(current.Length(), MIN_SEGMENT_LENGTH));
+            min_duration = std::max(min_duration, std::min(current.Length(), options.min_segment_length));
             current = Segment(current_time, current_time + min_duration);
             for (int i = 0; i < satellites; i++) {
                 if (paired[i] != -1) {
@@ -169,10 +285,10 @@ public:
                     long long real_freed_space = freed_time * satellite_types[i].freeing_speed;
                     assert(freed_time != 0);
                     int f = paired[i] - satellites;
-                    insert_segment(result.transmission_segments[f][i], 
-                        Segment(current.l, current.l + freed_time));
+                    add_segment(f, i, Segment(current.l, current.l + freed_time));
                     space_used[i] -= real_freed_space;
                     result.total_data += real_freed_space;
+                    mark_changed(i);
                 } else if (satellite_visible[i]) {
                     // Emulate doing photoshooting.
                     // We can't exceed the satellite's disk space.
@@ -182,17 +298,38 @@ public:
                     if (filled_time > 0) {
                         long long real_filled_space = filled_time * satellite_types[i].filling_speed;
                         space_used[i] += real_filled_space;
-                        insert_segment(result.shooting_segments[i], 
-                            Segment(current.l, current.l + filled_time));
+                        add_segment(-1, i, Segment(current.l, current.l + filled_time));
+                        mark_changed(i);
                     }
                 }
             }
             current_time += min_duration;
-            result.actions.push_back(paired);
+            if (options.record_actions) {
+                result.actions.Append(paired);
+            }
+        }
+        if (sink != nullptr) {
+            for (int i = 0; i < satellites; i++) {
+                if (open_segments[i].segment.Length() > 0) {
+                    sink->Push(open_segments[i].facility, i, open_segments[i].segment);
+                }
+            }
+            sink->Finish();
+        }
+        if (matching == Matching::INCREMENTAL) {
+            matching_expansions = incremental_matching.Expansions();
+        } else if (use_bitset) {
+            matching_expansions = bitset_matching_16.Expansions() + bitset_matching_64.Expansions();
         }
         return result;
     }
 
+    // Returns the number of satellites whose edges were scanned by the matching algorithm
+    // during the last run. Counts the same unit for all matching modes.
+    long long MatchingExpansions() const {
+        return matching_expansions;
+    }
+
 private:
     // Runs Kuhn's algorithm on the given `graph` using `perm` order.
     std::vector<int> RunKuhn(int facilities, int satellites, 
@@ -220,6 +357,7 @@ private:
             return false;
         }
         used[v] = 1;
+        matching_expansions++;
         for (int to : graph[v]) {
             if (paired[to] == -1 || RunDfs(paired[to], graph, used, paired)) {
                 paired[to] = v, paired[v] = to;
@@ -235,4 +373,9 @@ private:
         space_used += potential_filling * satellite.filling_speed;
         return double(space_used) / double(satellite.filling_speed) * double(satellite.freeing_speed);
     }
+
+    Matching matching;
+    GreedyEventBasedSolverOptions options;
+    ScheduleSink* sink;
+    long long matching_expansions = 0;
 };
@@ -1,3 +1,13 @@
+// Parameters of the heuristics of `GreedyQuantizedTimeSolver`.
+// Defaults are the best values determined during tests, see `SolverTuner` to retune them.
+struct GreedyQuantizedTimeSolverOptions {
+    // Satellite which is able to do photoshooting transmits data only if its disk
+    // is filled at least by this ratio.
+    double space_used_ratio = 0.85;
+    // How far in future (in quanta) we look to estimate potential data coming from photoshooting.
+    int future_segments = 630;
+};
+
 // The main solver combining different ideas:
 // 1. Quantization of time segments and solving each segment 
 //    without changing any assingments inside it.
@@ -6,51 +16,57 @@
 // 4. Some other heuristics used across the code.
 class GreedyQuantizedTimeSolver : public Solver {
 public:
+    // How the solver moves through time.
+    enum class Stepping {
+        // Solves every quantum separately.
+        EVERY_QUANTUM,
+        // Skips quanta where the greedy assignment is guaranteed to stay the same
+        // and applies it in closed form. Results are identical to `EVERY_QUANTUM`.
+        SKIP_QUIET,
+    };
+
+    explicit GreedyQuantizedTimeSolver(Stepping _stepping = Stepping::EVERY_QUANTUM,
+        const GreedyQuantizedTimeSolverOptions& _options = {}): stepping(_stepping), options(_options) {}
+
     TransmissionResult GetTransmissionSchedule(
-        const std::vector<std::vector<std::vector<Segment>>>& facility_visibility,
-        const std::vector<std::vector<Segment>>& satellite_visibility,
+        const VisibilityStore& visibility,
         const std::vector<SatelliteType>& satellite_types,
-        const std::vector<std::vector<int>>& precalculated_actions,
+        const TransmissionResult* previous_result = nullptr,
         int selected_iteration = -1) override {
         long long min_timestamp = std::numeric_limits<long long>::max();
         long long max_timestamp = 0;
-        for (const auto& facility_satellites : facility_visibility) {
-            for (const auto& satellite : facility_satellites) {
-                for (const auto& segment : satellite) {
-                    min_timestamp = std::min(min_timestamp, segment.l);
-                    max_timestamp = std::max(max_timestamp, segment.r);
-                }
-            }
-        }
-        for (const auto& satellite : satellite_visibility) {
-            for (const auto& segment : satellite) {
-                min_timestamp = std::min(min_timestamp, segment.l);
-                max_timestamp = std::max(max_timestamp, segment.r);
-            }
+        for (const auto& segment : visibility.All()) {
+            min_timestamp = std::min(min_timestamp, segment.l);
+            max_timestamp = std::max(max_timestamp, segment.r);
         }
-        int facilities = (int) facility_visibility.size();
-        int satellites = (int) facility_visibility[0].size();
-        std::vector<std::vector<int>> facility_iterators(facilities, std::vector<int>(satellites));
+        int facilities = visibility.Facilities();
+        int satellites = visibility.Satellites();
+        // `facility_iterators[i * satellites + j]` points to the current visibility segment
+        // of satellite `j` from facility `i`.
+        std::vector<int> facility_iterators(facilities * satellites);
         std::vector<int> satellite_iterators(satellites);
 
         // Returns the intersection of `segment` with 
         // current visibility interval for the given satellite. 
-        auto get_satellite_intersection = [&satellite_visibility, &satellite_iterators]
+        auto get_satellite_intersection = [&visibility, &satellite_iterators]
             (int i, const Segment& segment) {
-            if (satellite_iterators[i] == (int) satellite_visibility[i].size()) {
+            SegmentsView segments = visibility.Satellite(i);
+            if (satellite_iterators[i] == segments.size()) {
                 return Segment(0, 0);
             }
-            return satellite_visibility[i][satellite_iterators[i]].Intersect(segment);
+            return segments[satellite_iterators[i]].Intersect(segment);
         };
 
         // Returns the intersection of `segment` with current visibility interval 
         // for the given facility and satellite. 
-        auto get_facility_intersection = [&facility_visibility, &facility_iterators]
+        auto get_facility_intersection = [&visibility, &facility_iterators, satellites]
             (int i, int j, const Segment& segment) {
-            if (facility_iterators[i][j] == (int) facility_visibility[i][j].size()) {
+            SegmentsView segments = visibility.Facility(i, j);
+            int iterator = facility_iterators[i * satellites + j];
+            if (iterator == segments.size()) {
                 return Segment(0, 0);
             }
-            return facility_visibility[i][j][facility_iterators[i][j]].Intersect(segment);
+            return segments[iterator].Intersect(segment);
         };
 
         // Inserts segments to vector and potentially merges it with the previous one.
@@ -67,43 +83,224 @@ public:
         // All facilities that are available for given satellite 
         // for data transmission during given iteration.
         std::vector<std::vector<int>> graph(satellites);
-        // Indicates if actions from `precalculated_actions` should be used 
+        // The same edges as bitmasks of facilities, used instead of `graph` by `BitsetMatching`
+        // if there are at most 64 facilities.
+        bool use_bitset = 0 < facilities && facilities <= 64;
+        std::vector<uint64_t> adjacent(satellites);
+        auto has_graph_edges = [&](int i) {
+            return use_bitset ? adjacent[i] != 0 : !graph[i].empty();
+        };
+        BitsetMatching<16> bitset_matching_16(satellites);
+        BitsetMatching<64> bitset_matching_64(satellites);
+        // Indicates if actions from `previous_result` should be used 
         // or if the new greedy assignment should be recalculated.
-        bool recalculate = precalculated_actions.empty();
+        bool recalculate = previous_result == nullptr;
         // Quantize time by segments of `FRAGMENT_LENGTH` millis. 
         // In each segment we never change any assignments between facilities and satellites.
         const long long FRAGMENT_LENGTH = 1000;
+        // How often (in iterations) the solver state is saved to `result.checkpoints`.
+        const long long CHECKPOINT_INTERVAL = 10000;
         TransmissionResult result(facilities, satellites);
-        const double SPACE_USED_RATIO = 0.85;
-        for (long long iteration = 0, t = min_timestamp; 
+        long long first_iteration = 0;
+        // Reads actions of `previous_result` starting from `first_iteration`.
+        ActionLog::Cursor replayed_actions;
+        if (!recalculate) {
+            // Resume from the latest checkpoint before the selected iteration 
+            // instead of replaying all the previous actions.
+            if (const SolverCheckpoint* checkpoint = previous_result->FindCheckpoint(selected_iteration)) {
+                result.RestoreCheckpoint(*previous_result, *checkpoint);
+                space_used = checkpoint->space_used;
+                satellite_iterators.assign(checkpoint->positions.begin(), 
+                    checkpoint->positions.begin() + satellites);
+                facility_iterators.assign(checkpoint->positions.begin() + satellites, 
+                    checkpoint->positions.end());
+                first_iteration = checkpoint->iteration;
+            }
+            replayed_actions = ActionLog::Cursor(&previous_result->actions, (int) first_iteration);
+        }
+        // Returns cost of satellite `i` for the quantum starting at `t` if it had `space` used.
+        auto get_cost = [&](int i, long long t, long long space) {
+            return GetCost(space, 
+                get_satellite_intersection(i, Segment(t, t + FRAGMENT_LENGTH * options.future_segments)).Length(),
+                satellite_types[i]);
+        };
+
+        // State used to find quiet quanta in `Stepping::SKIP_QUIET` mode.
+        // All starts and ends of visibility segments in the sorted order.
+        std::vector<long long> boundaries;
+        if (stepping == Stepping::SKIP_QUIET) {
+            SegmentsView segments = visibility.All();
+            boundaries.insert(boundaries.end(), segments.l, segments.l + segments.size());
+            boundaries.insert(boundaries.end(), segments.r, segments.r + segments.size());
+            sort(boundaries.begin(), boundaries.end());
+        }
+        size_t next_boundary = 0;
+        // Per-satellite state: indicates if photoshooting is possible, number of facilities
+        // from which the satellite is visible and change of the used disk space per quantum.
+        std::vector<char> quiet_photo(satellites);
+        std::vector<int> quiet_visible(satellites);
+        std::vector<long long> quiet_delta(satellites);
+        // Returns how many quanta following the just emulated quantum starting at `t` 
+        // are guaranteed to get exactly the same assignment `paired` from the greedy algorithm
+        // and to be emulated the same way, so they could be applied in closed form.
+        //
+        // The assignment depends only on the graph and on the relative order of satellites
+        // having any edges. Inside the quiet quanta no visibility segment starts or ends,
+        // no disk gets empty or full and the disk space of each satellite changes linearly.
+        // Edges depend on the disk space monotonically and costs are linear functions,
+        // so it's enough to check both ends of the range.
+        auto count_quiet_quanta = [&](long long t, long long iteration,
+            const std::vector<int>& paired, const std::vector<int>& perm) -> long long {
+            while (next_boundary < boundaries.size() && boundaries[next_boundary] <= t) {
+                next_boundary++;
+            }
+            long long next_event = next_boundary < boundaries.size() 
+                ? std::min(boundaries[next_boundary], max_timestamp) : max_timestamp;
+            // Quiet quanta should end before the next event and should not skip any checkpoint.
+            long long limit = std::min((next_event - t) / FRAGMENT_LENGTH - 1,
+                (iteration / CHECKPOINT_INTERVAL + 1) * CHECKPOINT_INTERVAL - 1 - iteration);
+            if (limit <= 0) {
+                return 0;
+            }
+            for (int i = 0; i < satellites; i++) {
+                SegmentsView segments = visibility.Satellite(i);
+                quiet_photo[i] = satellite_iterators[i] < segments.size() 
+                    && segments.l[satellite_iterators[i]] <= t;
+            }
+            for (int i = 0; i < satellites; i++) {
+                const SatelliteType& type = satellite_types[i];
+                quiet_delta[i] = 0;
+                if (paired[i] != -1) {
+                    quiet_delta[i] = -type.freeing_speed * FRAGMENT_LENGTH;
+                } else if (quiet_photo[i]) {
+                    long long space_left = type.space * 1000 - space_used[i];
+                    if (space_left >= type.filling_speed * FRAGMENT_LENGTH) {
+                        quiet_delta[i] = type.filling_speed * FRAGMENT_LENGTH;
+                    } else if (space_left >= type.filling_speed) {
+                        // The disk is going to be filled partially.
+                        return 0;
+                    }
+                }
+            }
+            // `k`-th quantum after the emulated one.
+            auto get_space = [&](int i, long long k) {
+                return space_used[i] + (k - 1) * quiet_delta[i];
+            };
+            // Index of the linear piece of the future photoshooting length used in cost.
+            auto get_future_piece = [&](int i, long long k) {
+                SegmentsView segments = visibility.Satellite(i);
+                int iterator = satellite_iterators[i];
+                if (iterator == segments.size()) {
+                    return 0;
+                }
+                long long future_end = t + k * FRAGMENT_LENGTH + FRAGMENT_LENGTH * options.future_segments;
+                return int(future_end > segments.l[iterator]) + int(future_end > segments.r[iterator]);
+            };
+            auto has_edges = [&](int i, long long space) {
+                return space != 0 && (!quiet_photo[i] 
+                    || double(space) * 0.001 / double(satellite_types[i].space) >= options.space_used_ratio);
+            };
+            // Checks that first `k` quanta after the emulated one are quiet.
+            auto is_quiet = [&](long long k) {
+                for (int i = 0; i < satellites; i++) {
+                    const SatelliteType& type = satellite_types[i];
+                    long long space = get_space(i, k);
+                    if (paired[i] != -1 && space < type.freeing_speed * FRAGMENT_LENGTH) {
+                        return false;
+                    }
+                    if (quiet_delta[i] > 0 && type.space * 1000 - space < type.filling_speed * FRAGMENT_LENGTH) {
+                        return false;
+                    }
+                    if (quiet_visible[i] > 0 && has_edges(i, space) != has_graph_edges(i)) {
+                        return false;
+                    }
+                    if (has_graph_edges(i) && get_future_piece(i, 1) != get_future_piece(i, k)) {
+                        return false;
+                    }
+                }
+                // Order of satellites with edges should stay strict. The margin covers rounding errors,
+                // so the order of computed costs is the same as the order of their exact linear values.
+                const double COST_MARGIN = 1e-9;
+                int previous = -1;
+                for (int i : perm) {
+                    if (!has_graph_edges(i)) {
+                        continue;
+                    }
+                    if (previous != -1) {
+                        for (long long quantum : {1ll, k}) {
+                            long long quantum_t = t + quantum * FRAGMENT_LENGTH;
+                            if (get_cost(previous, quantum_t, get_space(previous, quantum)) 
+                                <= get_cost(i, quantum_t, get_space(i, quantum)) * (1 + COST_MARGIN)) {
+                                return false;
+                            }
+                        }
+                    }
+                    previous = i;
+                }
+                return true;
+            };
+            if (!is_quiet(1)) {
+                return 0;
+            }
+            // Quiet ranges are prefix-closed, so the longest one is found by binary search.
+            long long low = 1;
+            long long high = limit + 1;
+            while (high - low > 1) {
+                long long middle = (low + high) / 2;
+                if (is_quiet(middle)) {
+                    low = middle;
+                } else {
+                    high = middle;
+                }
+            }
+            return low;
+        };
+
+        for (long long iteration = first_iteration, t = min_timestamp + first_iteration * FRAGMENT_LENGTH; 
             t < max_timestamp; iteration++, t += FRAGMENT_LENGTH) {
             if (t % 10000000 == 0) {
                 std::cerr << "Progress: " << round(double(t - min_timestamp) * 100. 
                     / double(max_timestamp - min_timestamp)) << "%\n";
             }
+            if (iteration % CHECKPOINT_INTERVAL == 0) {
+                SolverCheckpoint checkpoint = result.MakeCheckpoint(iteration);
+                checkpoint.space_used = space_used;
+                checkpoint.positions = satellite_iterators;
+                checkpoint.positions.insert(checkpoint.positions.end(), 
+                    facility_iterators.begin(), facility_iterators.end());
+                result.checkpoints.push_back(std::move(checkpoint));
+            }
 
             for (int i = 0; i < satellites; i++) {
                 graph[i].clear();
+                adjacent[i] = 0;
             }
 
             // Advance iterators for satellite and facility visibility segments.
             Segment current(t, std::min(max_timestamp, t + FRAGMENT_LENGTH));
+            bool find_quiet = stepping == Stepping::SKIP_QUIET && recalculate;
             for (int i = 0; i < satellites; i++) {
-                const auto& segments = satellite_visibility[i];
-                while (satellite_iterators[i] < (int) segments.size() 
-                        && segments[satellite_iterators[i]].r <= t) {
+                SegmentsView segments = visibility.Satellite(i);
+                while (satellite_iterators[i] < segments.size() 
+                        && segments.r[satellite_iterators[i]] <= t) {
                     satellite_iterators[i]++;
                 }
+                if (find_quiet) {
+                    quiet_visible[i] = 0;
+                }
             }
             for (int i = 0; i < facilities; i++) {
                 for (int j = 0; j < satellites; j++) {
-                    const auto& segments = facility_visibility[i][j];
-                    while (facility_iterators[i][j] < (int) segments.size() 
-                        && segments[facility_iterators[i][j]].r <= t) {
-                        facility_iterators[i][j]++;
+                    SegmentsView segments = visibility.Facility(i, j);
+                    int& iterator = facility_iterators[i * satellites + j];
+                    while (iterator < segments.size() && segments.r[iterator] <= t) {
+                        iterator++;
                     }
-                    if (facility_iterators[i][j] < (int) segments.size() 
-                        && segments[facility_iterators[i][j]].Intersects(current)) {
+                    // Edges are needed only if the assignment is going to be recalculated.
+                    if (recalculate && iterator < segments.size() && segments[iterator].Intersects(current)) {
+                        if (find_quiet) {
+                            quiet_visible[j]++;
+                        }
                         // Never try to transmit any data from satellite without any data used.
                         if (space_used[j] == 0) {
                             continue;
@@ -117,39 +314,43 @@ public:
                         // Create an edge between satellite and facility only 
                         // if satellite is unable to do photoshooting 
                         // or if it's getting out of space.
-                        // `SPACE_USED_RATIO` is assigned to the best value 
-                        // determined during tests.
                         if (get_satellite_intersection(j, current).Length() == 0 
-                            || double(space_used[j]) * 0.001 / double(satellite_types[j].space) >= SPACE_USED_RATIO) {
-                            graph[j].push_back(satellites + i);
+                            || double(space_used[j]) * 0.001 / double(satellite_types[j].space) >= options.space_used_ratio) {
+                            if (use_bitset) {
+                                adjacent[j] |= uint64_t(1) << i;
+                            } else {
+                                graph[j].push_back(satellites + i);
+                            }
                         }
                     }
                 }
             }
 
-            // Weighted Kuhn's algorithm implementation.
-            // All satellites are ordered by their cost in the descending order.
-            // The less time is needed to fully occupy satellite's disk space the bigger is cost.
-            // This allows to free up the most critical satellites.
-            std::vector<double> cost(satellites);
-            // How far in future we look to estimate potential data coming from photoshooting.
-            const int FUTURE_SEGMENTS = 630;
-            for (int i = 0; i < satellites; i++) {
-                cost[i] = GetCost(space_used[i], 
-                    get_satellite_intersection(i, 
-                    Segment(t, t + FRAGMENT_LENGTH * FUTURE_SEGMENTS)).Length(), 
-                    satellite_types[i]);
-            }
-            std::vector<int> perm(satellites);
-            iota(perm.begin(), perm.end(), 0);
-            sort(perm.begin(), perm.end(), [&](int i, int j) { return cost[i] > cost[j]; });
-            
             std::vector<int> paired;
+            std::vector<int> perm;
             if (recalculate) {
-                paired = RunKuhn(facilities, satellites, graph, perm);
+                // Weighted Kuhn's algorithm implementation.
+                // All satellites are ordered by their cost in the descending order.
+                // The less time is needed to fully occupy satellite's disk space the bigger is cost.
+                // This allows to free up the most critical satellites.
+                std::vector<double> cost(satellites);
+                for (int i = 0; i < satellites; i++) {
+                    cost[i] = get_cost(i, t, space_used[i]);
+                }
+                perm.resize(satellites);
+                iota(perm.begin(), perm.end(), 0);
+                sort(perm.begin(), perm.end(), [&](int i, int j) { return cost[i] > cost[j]; });
+                if (use_bitset && facilities <= 16) {
+                    paired = bitset_matching_16.Run(facilities, adjacent, perm);
+                } else if (use_bitset) {
+                    paired = bitset_matching_64.Run(facilities, adjacent, perm);
+                } else {
+                    paired = RunKuhn(facilities, satellites, graph, perm);
+                }
             } else {
                 // Reuse action from the previous step.
-                paired = precalculated_actions[iteration];
+                paired = replayed_actions.Row();
+                replayed_actions.Next();
                 if (iteration == selected_iteration) {
                     bool changed = false;
                     // Try to unassign from transmission all satellites 
@@ -163,9 +364,10 @@ public:
                             break;
                         }
                     }
-                    // If the mutation didn't change anything, there is no need to continue.
+                    // If the mutation didn't change anything, there is no need to continue,
+                    // the schedule is going to be the same as the previous one.
                     if (!changed) {
-                        return result;
+                        return *previous_result;
                     }
                     // Use greedy algorithm going forward.
                     recalculate = true;
@@ -200,7 +402,36 @@ public:
                     }
                 }
             }
-            result.actions.push_back(paired);
+            result.actions.Append(paired);
+
+            // Apply the same assignment to all following quiet quanta at once.
+            if (find_quiet && !perm.empty()) {
+                long long quiet = count_quiet_quanta(t, iteration, paired, perm);
+                if (quiet == 0) {
+                    continue;
+                }
+                Segment skipped(t + FRAGMENT_LENGTH, t + (quiet + 1) * FRAGMENT_LENGTH);
+                for (int i = 0; i < satellites; i++) {
+                    if (paired[i] != -1) {
+                        long long freed_space = -quiet_delta[i] * quiet;
+                        insert_segment(result.transmission_segments[paired[i] - satellites][i], skipped);
+                        space_used[i] -= freed_space;
+                        result.total_data += freed_space;
+                    } else if (quiet_delta[i] > 0) {
+                        insert_segment(result.shooting_segments[i], skipped);
+                        space_used[i] += quiet_delta[i] * quiet;
+                    } else if (quiet_photo[i] && space_used[i] < satellite_types[i].space * 1000) {
+                        // Disk is almost full, so only empty photoshooting segments are produced.
+                        for (long long k = 1; k <= quiet; k++) {
+                            insert_segment(result.shooting_segments[i], 
+                                Segment(t + k * FRAGMENT_LENGTH, t + k * FRAGMENT_LENGTH));
+                        }
+                    }
+                }
+                result.actions.Repeat((int) quiet);
+                iteration += quiet;
+                t += quiet * FRAGMENT_LENGTH;
+            }
         }
         return result;
     }
@@ -247,4 +478,7 @@ private:
         space_used += potential_filling * satellite.filling_speed;
         return double(space_used) / double(satellite.filling_speed) * double(satellite.freeing_speed);
     }
+
+    Stepping stepping;
+    GreedyQuantizedTimeSolverOptions options;
 };
@@ -0,0 +1,155 @@
+// Bipartite matching between satellites and facilities that is maintained across iterations
+// instead of being rebuilt from scratch.
+//
+// Satellites are indexed from 0 to `satellites - 1`, facilities are indexed
+// from `satellites` to `satellites + facilities - 1` (the same as in `graph` used by solvers).
+// Satellites have priorities given by `perm` (earlier is more important) and the matching
+// always covers the set of satellites that greedy algorithm would choose: every satellite
+// is matched if and only if it can be matched together with all more important matched ones.
+//
+// Each update keeps all pairs from the previous iteration that are still present in `graph`
+// and only searches for alternating paths from the unmatched satellites that have any edges.
+class IncrementalMatching {
+public:
+    IncrementalMatching(int _satellites, int _facilities):
+        satellites(_satellites),
+        paired(_satellites + _facilities, -1), rank(_satellites), visited(_satellites + _facilities),
+        parent(_satellites + _facilities, -1), queue(_satellites) {}
+
+    // Updates the matching for the new `graph` and priority order `perm`.
+    // Returns `paired` array: `paired[i]` is the facility (shifted by `satellites`) matched
+    // to satellite `i` or -1 otherwise.
+    const std::vector<int>& Update(const std::vector<std::vector<int>>& graph, const std::vector<int>& perm) {
+        // Drop all pairs that correspond to disappeared edges.
+        for (int i = 0; i < satellites; i++) {
+            int to = paired[i];
+            if (to != -1 && find(graph[i].begin(), graph[i].end(), to) == graph[i].end()) {
+                paired[i] = paired[to] = -1;
+            }
+        }
+        for (int i = 0; i < satellites; i++) {
+            rank[perm[i]] = i;
+        }
+        generation++;
+        int free_facilities = 0;
+        for (int i = satellites; i < (int) paired.size(); i++) {
+            free_facilities += paired[i] == -1;
+        }
+        // Rank of the least important matched satellite, nothing below it could be exchanged.
+        int worst_rank = WorstRank();
+        // Process satellites in the priority order, so all more important ones are already settled.
+        // Any exchange only unmatches less important satellite which is going to be processed later.
+        for (int i = 0; i < satellites; i++) {
+            int v = perm[i];
+            if (paired[v] != -1 || graph[v].empty()) {
+                continue;
+            }
+            if (free_facilities == 0 && i > worst_rank) {
+                break;
+            }
+            SearchResult search_result = Augment(v, graph);
+            if (search_result == SearchResult::AUGMENTED) {
+                free_facilities--;
+                worst_rank = std::max(worst_rank, i);
+            } else if (search_result == SearchResult::EXCHANGED) {
+                worst_rank = WorstRank();
+            }
+        }
+        return paired;
+    }
+
+    // Returns the number of satellites whose edges were scanned by searches of alternating paths so far.
+    // Counts the same unit as `BitsetMatching::Expansions` and Kuhn's algorithm in `GreedyEventBasedSolver`.
+    long long Expansions() const {
+        return expansions;
+    }
+
+private:
+    enum class SearchResult {
+        NOT_FOUND,
+        // The matching was extended with the new pair.
+        AUGMENTED,
+        // One of the matched satellites was replaced.
+        EXCHANGED,
+    };
+
+    // Returns the rank of the least important matched satellite or -1 if there are none.
+    int WorstRank() const {
+        int result = -1;
+        for (int i = 0; i < satellites; i++) {
+            if (paired[i] != -1) {
+                result = std::max(result, rank[i]);
+            }
+        }
+        return result;
+    }
+
+    // Searches for the alternating path from the unmatched satellite `root`.
+    // Extends the matching if the path ends at the free facility. Otherwise, replaces
+    // the least important reachable satellite with `root` if it's less important than `root`.
+    // Vertices visited by the previous unsuccessful searches are skipped: the matching didn't change
+    // since then, so they can't reach neither free facility nor less important satellite.
+    SearchResult Augment(int root, const std::vector<std::vector<int>>& graph) {
+        int head = 0;
+        int tail = 0;
+        queue[tail++] = root;
+        visited[root] = generation;
+        int worst = -1;
+        while (head < tail) {
+            int v = queue[head++];
+            expansions++;
+            for (int to : graph[v]) {
+                if (visited[to] == generation) {
+                    continue;
+                }
+                visited[to] = generation;
+                parent[to] = v;
+                if (paired[to] == -1) {
+                    Flip(to);
+                    generation++;
+                    return SearchResult::AUGMENTED;
+                }
+                int u = paired[to];
+                if (visited[u] != generation) {
+                    visited[u] = generation;
+                    queue[tail++] = u;
+                    if (worst == -1 || rank[u] > rank[worst]) {
+                        worst = u;
+                    }
+                }
+            }
+        }
+        if (worst != -1 && rank[worst] > rank[root]) {
+            int to = paired[worst];
+            paired[worst] = paired[to] = -1;
+            Flip(to);
+            generation++;
+            return SearchResult::EXCHANGED;
+        }
+        return SearchResult::NOT_FOUND;
+    }
+
+    // Flips the alternating path ending at the free facility `to` using `parent` links.
+    void Flip(int to) {
+        while (to != -1) {
+            int v = parent[to];
+            int next = paired[v];
+            paired[v] = to;
+            paired[to] = v;
+            to = next;
+        }
+    }
+
+    int satellites;
+    std::vector<int> paired;
+    // Position of each satellite in the current priority order.
+    std::vector<int> rank;
+    // Stores the generation of the last search which visited the vertex.
+    // Generation changes once the matching or the graph is changed.
+    std::vector<int> visited;
+    // For facilities, stores the satellite from which the facility was reached.
+    std::vector<int> parent;
+    std::vector<int> queue;
+    int generation = 0;
+    long long expansions = 0;
+};
@@ -0,0 +1,103 @@
+// Parameters of the local search, see `LocalSearchDriver`.
+struct LocalSearchOptions {
+    // Decides whether the best candidate of the round replaces the current result.
+    enum class Acceptance {
+        // Accepts the candidate only if it's strictly better than the current result.
+        IMPROVEMENT,
+        // Accepts the candidate if it's worse than the current result by at most `threshold`.
+        // Allows to walk across plateaus, the best result found so far is still returned.
+        THRESHOLD,
+    };
+
+    // Number of mutations. Iterations of the initial result are split into `batches`
+    // equal ranges and each mutation is applied at the random iteration of its own range.
+    int batches = 300;
+    // Number of mutations applied to the same result before the improvements are merged.
+    // The final result depends only on `seed` and `round_size`, not on the number of threads,
+    // so it's fixed instead of being derived from the size of the thread pool. Values below 1 stand for 1.
+    int round_size = 8;
+    unsigned long long seed = 0;
+    Acceptance acceptance = Acceptance::IMPROVEMENT;
+    // Is stored in 0.001 MiBs, used only by `Acceptance::THRESHOLD`.
+    long long threshold = 0;
+    // Checks every candidate with `ScheduleVerifier` and discards the invalid ones.
+    bool verify = false;
+};
+
+// Iteratively improves the schedule by mutating previously achieved result.
+// Mutations of each round are solved concurrently on the thread pool against the same
+// (read-only) current result and visibility data, then the best candidate is merged
+// according to the acceptance policy.
+class LocalSearchDriver {
+public:
+    // `make_solver` creates solver used by a single mutation,
+    // so solvers never have to be shared between threads.
+    LocalSearchDriver(ThreadPool& _pool, std::function<std::unique_ptr<Solver>()> _make_solver,
+        const LocalSearchOptions& _options):
+        pool(_pool), make_solver(std::move(_make_solver)), options(_options) {}
+
+    TransmissionResult Run(const VisibilityStore& visibility,
+        const std::vector<SatelliteType>& satellite_types, TransmissionResult initial_result) {
+        TransmissionResult current = std::move(initial_result);
+        TransmissionResult best = current;
+        int iterations = current.actions.Size();
+        int batch_size = iterations / options.batches;
+        if (batch_size == 0) {
+            return best;
+        }
+        int round_size = std::max(options.round_size, 1);
+        ScheduleVerifier verifier(visibility, satellite_types);
+        for (int first = 0; first < options.batches; first += round_size) {
+            int tasks = std::min(round_size, options.batches - first);
+            std::mutex candidate_mutex;
+            TransmissionResult candidate(0, 0);
+            int candidate_batch = -1;
+            pool.ParallelFor(tasks, [&](int task) {
+                int batch = first + task;
+                // Every mutation has its own generator,
+                // so the result doesn't depend on the order in which tasks are executed.
+                std::mt19937_64 rng(options.seed * 1000003 + batch);
+                int iteration = batch * batch_size + int(rng() % batch_size);
+                std::unique_ptr<Solver> solver = make_solver();
+                TransmissionResult result = solver->GetTransmissionSchedule(visibility,
+                    satellite_types, &current, iteration);
+                // Candidates are already verified concurrently, so the verifier doesn't use the pool.
+                if (options.verify && !verifier.Verify(result).Ok()) {
+                    return;
+                }
+                // Keep only the best candidate to save memory, ties are resolved by the batch index.
+                std::lock_guard<std::mutex> lock(candidate_mutex);
+                if (candidate_batch == -1 || result.total_data > candidate.total_data
+                    || (result.total_data == candidate.total_data && batch < candidate_batch)) {
+                    candidate = std::move(result);
+                    candidate_batch = batch;
+                }
+            });
+            // All candidates of the round could be discarded by the verifier.
+            if (candidate_batch != -1 && Accept(candidate, current)) {
+                current = std::move(candidate);
+                if (current.total_data > best.total_data) {
+                    best = current;
+                }
+            }
+            std::cerr << "Currently achieved maximum (BATCH #" << first + tasks << "/" << options.batches
+                << "): " << best.total_data << "\n";
+        }
+        return best;
+    }
+
+private:
+    bool Accept(const TransmissionResult& candidate, const TransmissionResult& current) const {
+        switch (options.acceptance) {
+            case LocalSearchOptions::Acceptance::IMPROVEMENT:
+                return candidate.total_data > current.total_data;
+            case LocalSearchOptions::Acceptance::THRESHOLD:
+                return candidate.total_data >= current.total_data - options.threshold;
+        }
+        return false;
+    }
+
+    ThreadPool& pool;
+    std::function<std::unique_ptr<Solver>()> make_solver;
+    LocalSearchOptions options;
+};
@@ -0,0 +1,53 @@
+// Helper struct providing read-only access to the whole file contents through `mmap`.
+// The mapping is released once the object is destroyed.
+struct MappedFile {
+    const char* data = nullptr;
+    size_t size = 0;
+
+    MappedFile() = default;
+    explicit MappedFile(const std::string& filename) {
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd == -1) {
+            return;
+        }
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            void* mapped = mmap(nullptr, size_t(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped != MAP_FAILED) {
+                // Input files are always processed from the beginning to the end.
+                madvise(mapped, size_t(info.st_size), MADV_SEQUENTIAL);
+                data = static_cast<const char*>(mapped);
+                size = size_t(info.st_size);
+            }
+        }
+        close(fd);
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept: data(other.data), size(other.size) {
+        other.data = nullptr;
+        other.size = 0;
+    }
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        std::swap(data, other.data);
+        std::swap(size, other.size);
+        return *this;
+    }
+    ~MappedFile() {
+        if (data != nullptr) {
+            munmap(const_cast<char*>(data), size);
+        }
+    }
+
+    // Returns true if the file was opened and mapped successfully.
+    bool IsValid() const {
+        return data != nullptr;
+    }
+
+    const char* begin() const {
+        return data;
+    }
+    const char* end() const {
+        return data + size;
+    }
+};
@@ -41,28 +41,104 @@ struct Reader {
         return make_pair(facility, result);
     }
 
+    // Parses the same format as `ReadFile` but walks the memory-mapped file contents once
+    // without allocating anything per line. Produces exactly the same result as `ReadFile`.
+    static std::pair<std::string, std::map<std::string, std::vector<Segment>>> ReadFileMapped(
+        const std::string& filename) {
+        MappedFile file(filename);
+        std::map<std::string, std::vector<Segment>> result;
+        if (!file.IsValid()) {
+            return make_pair(std::string(), result);
+        }
+        bool parse = false;
+        std::string_view facility;
+        std::string_view satellite_name;
+        // Segments of the current satellite, looked up lazily on the first parsed row.
+        std::vector<Segment>* segments = nullptr;
+        for (const char* it = file.begin(); it < file.end();) {
+            const char* line_end = static_cast<const char*>(memchr(it, '\n', size_t(file.end() - it)));
+            if (line_end == nullptr) {
+                line_end = file.end();
+            }
+            std::string_view line(it, size_t(line_end - it));
+            const char* first = it;
+            while (first < line_end && *first == ' ') {
+                first++;
+            }
+            // Fast path: rows inside the table always start with the access number.
+            if (parse && first < line_end && isdigit(*first)) {
+                if (segments == nullptr) {
+                    segments = &result[std::string(satellite_name)];
+                }
+                Time::ParseNumber(first, line_end);
+                long long l = Time::ParseTimestamp(first, line_end);
+                long long r = Time::ParseTimestamp(first, line_end);
+                segments->push_back(Segment(l, r));
+            } else {
+                if (size_t ind = line.find("-To-"); ind != std::string_view::npos) {
+                    facility = line.substr(0, ind);
+                    satellite_name = line.substr(ind + 4);
+                    segments = nullptr;
+                }
+                if (line.find("Start Time (UTCG)") != std::string_view::npos) {
+                    parse = true;
+                }
+                if (line.compare(0, 12, "Min Duration") == 0) {
+                    parse = false;
+                }
+            }
+            it = line_end + 1;
+        }
+        return make_pair(std::string(facility), result);
+    }
+
+    // Returns all files in the `directory` whose names start with `prefix` in the sorted order.
+    static std::vector<std::string> ListFiles(const std::string& directory, const std::string& prefix) {
+        std::vector<std::string> result;
+        for (const auto& file : fs::directory_iterator(directory)) {
+            if (StartsWith(file.path().stem(), prefix)) {
+                result.push_back(file.path());
+            }
+        }
+        sort(result.begin(), result.end());
+        return result;
+    }
+
+    // Parses all given files, concurrently if `pool` is provided.
+    // The result is ordered the same way as `filenames` regardless of the number of threads.
+    static std::vector<std::pair<std::string, std::map<std::string, std::vector<Segment>>>> ReadFiles(
+        const std::vector<std::string>& filenames, ThreadPool* pool) {
+        std::vector<std::pair<std::string, std::map<std::string, std::vector<Segment>>>> result(filenames.size());
+        auto read_file = [&](int i) {
+            result[i] = ReadFileMapped(filenames[i]);
+        };
+        if (pool != nullptr) {
+            pool->ParallelFor((int) filenames.size(), read_file);
+        } else {
+            for (int i = 0; i < (int) filenames.size(); i++) {
+                read_file(i);
+            }
+        }
+        return result;
+    }
+
     // Reads all facility-satellite visibility files.
+    // Files are parsed in parallel on `pool` (if provided) and merged afterwards.
     static std::map<std::string, std::map<std::string, std::vector<Segment>>> ReadFacilityVisibility(
-        const std::string& directory) {
+        const std::string& directory, ThreadPool* pool = nullptr) {
         std::map<std::string, std::map<std::string, std::vector<Segment>>> result;
-        for (const auto& file : fs::directory_iterator(directory)) {
-            if (!StartsWith(file.path().stem(), "Facility")) {
-                continue;
-            }
-            auto [facility, satellites] = ReadFile(file.path());
-            result[facility] = satellites;
+        for (auto& [facility, satellites] : ReadFiles(ListFiles(directory, "Facility"), pool)) {
+            result[facility] = std::move(satellites);
         }
         return result;
     }
 
     // Reads all satellite visibility (for photoshooting) files.
-    static std::map<std::string, std::vector<Segment>> ReadSatelliteVisibility(const std::string& directory) {
+    // Files are parsed in parallel on `pool` (if provided) and merged afterwards.
+    static std::map<std::string, std::vector<Segment>> ReadSatelliteVisibility(
+        const std::string& directory, ThreadPool* pool = nullptr) {
         std::map<std::string, std::vector<Segment>> result;
-        for (const auto& file : fs::directory_iterator(directory)) {
-            if (!StartsWith(file.path().stem(), "Russia")) {
-                continue;
-            }
-            auto [facility, satellites] = ReadFile(file.path());
+        for (auto& [facility, satellites] : ReadFiles(ListFiles(directory, "Russia"), pool)) {
             assert(facility == "Russia");
             result.merge(satellites);
         }
@@ -53,30 +53,45 @@ struct ResultsReader {
         return std::make_pair(satellite_name, result);
     }
 
+    // Parses all given files, concurrently if `pool` is provided.
+    // The result is ordered the same way as `filenames` regardless of the number of threads.
+    static std::vector<std::pair<std::string, std::map<std::string, std::vector<Segment>>>> ReadFiles(
+        const std::vector<std::string>& filenames, bool is_facility, ThreadPool* pool) {
+        std::vector<std::pair<std::string, std::map<std::string, std::vector<Segment>>>> result(filenames.size());
+        auto read_file = [&](int i) {
+            result[i] = ReadFile(filenames[i], is_facility);
+        };
+        if (pool != nullptr) {
+            pool->ParallelFor((int) filenames.size(), read_file);
+        } else {
+            for (int i = 0; i < (int) filenames.size(); i++) {
+                read_file(i);
+            }
+        }
+        return result;
+    }
+
     // Reads all transmission-related data files.
+    // Files are parsed in parallel on `pool` (if provided) and merged afterwards.
     static std::map<std::string, std::map<std::string, std::vector<Segment>>> ReadDropFiles(
-        const std::string& directory) {
+        const std::string& directory, ThreadPool* pool = nullptr) {
         std::map<std::string, std::map<std::string, std::vector<Segment>>> result;
-        for (const auto& file : fs::directory_iterator(directory)) {
-            if (!StartsWith(file.path().stem(), "Drop")) {
-                continue;
-            }
-            auto [satellite, facilities] = ReadFile(file.path(), /*is_facility=*/true);
-            for (const auto& facility : facilities) {
-                result[facility.first][satellite] = facility.second;
+        for (auto& [satellite, facilities] : ReadFiles(Reader::ListFiles(directory, "Drop"),
+            /*is_facility=*/true, pool)) {
+            for (auto& [facility, segments] : facilities) {
+                result[facility][satellite] = std::move(segments);
             }
         }
         return result;
     }
 
     // Reads all photoshooting-related data files.
-    static std::map<std::string, std::vector<Segment>> ReadCameraFiles(const std::string& directory) {
+    // Files are parsed in parallel on `pool` (if provided) and merged afterwards.
+    static std::map<std::string, std::vector<Segment>> ReadCameraFiles(const std::string& directory,
+        ThreadPool* pool = nullptr) {
         std::map<std::string, std::vector<Segment>> result;
-        for (const auto& file : fs::directory_iterator(directory)) {
-            if (!StartsWith(file.path().stem(), "Camera")) {
-                continue;
-            }
-            auto [satellite, segments] = ReadFile(file.path(), /*is_facility=*/false);
+        for (auto& [satellite, segments] : ReadFiles(Reader::ListFiles(directory, "Camera"),
+            /*is_facility=*/false, pool)) {
             result.merge(segments);
         }
         return result;
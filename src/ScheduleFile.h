@@ -0,0 +1,284 @@
+// Schedule stored in the binary file, see `ScheduleFile`.
+struct Schedule {
+    // `facility_names[i]` is the name of facility `i`.
+    std::vector<std::string> facility_names;
+    // `satellite_names[j]` is the name of satellite `j`.
+    std::vector<std::string> satellite_names;
+    // Only the speeds and the disk space of the types are stored, other fields are empty.
+    std::vector<SatelliteType> satellite_types;
+    // `transmission_segments[i][j]` are transmissions of satellite `j` to facility `i`.
+    std::vector<std::vector<std::vector<Segment>>> transmission_segments;
+    // `shooting_segments[j]` are photoshooting segments of satellite `j`.
+    std::vector<std::vector<Segment>> shooting_segments;
+};
+
+// Helper struct used to store the whole schedule in the single compact binary file (.sch)
+// instead of hundreds of text files. It's emitted by `Writer::WriteBinarySchedule` (or by `ScheduleFileSink` during solving),
+// the text layout is rendered from it on demand by `exporter`.
+//
+// The file has the following layout:
+// 1. `Header`.
+// 2. `satellites + facilities + 1` offsets of the names in the names blob as 64-bit integers
+//    (satellites first, then facilities, both in the index order).
+// 3. Names blob.
+// 4. Stream of unsigned LEB128 varints of `stream_size` bytes:
+//    a) filling speed, freeing speed and disk space of each satellite;
+//    b) `facilities * satellites + satellites` segment lists: list `i * satellites + j` contains
+//       transmissions of satellite `j` to facility `i`, list `facilities * satellites + j` contains
+//       photoshooting segments of satellite `j`. Each list is the number of segments followed by
+//       the gap from the end of the previous segment (from `start` for the first one)
+//       and the length of each segment.
+// Segments in each list are sorted and never intersect, so all the deltas are small and non-negative.
+struct ScheduleFile {
+    struct Header {
+        char magic[8];
+        uint64_t facilities;
+        uint64_t satellites;
+        uint64_t names_size;
+        // The moment all segment lists start from.
+        uint64_t start;
+        uint64_t stream_size;
+    };
+    static constexpr char MAGIC[8] = {'S', 'A', 'T', 'S', 'C', 'H', '0', '1'};
+    // Name of the binary schedule file inside the schedule directory.
+    static constexpr const char* FILENAME = "schedule.sch";
+
+    // Builds the contents of the binary schedule file from segments added one by one,
+    // so the schedule doesn't have to be stored as `Segment`s at all (see `ScheduleFileSink`).
+    // Lists are kept already encoded in memory, which takes about 4 bytes per segment.
+    // Segments of each list have to be added in the order of time, lists could be interleaved.
+    class Encoder {
+    public:
+        Encoder(const std::vector<std::string>& _facility_names, const std::vector<std::string>& _satellite_names,
+            const std::vector<SatelliteType>& _satellite_types):
+            facility_names(_facility_names), satellite_names(_satellite_names), satellite_types(_satellite_types),
+            lists((facility_names.size() + 1) * satellite_names.size()) {}
+
+        // Adds the segment to list `list`, see the layout of the file.
+        void Add(int list, const Segment& segment) {
+            List& current = lists[list];
+            assert(segment.r >= segment.l && (current.count == 0 || segment.l >= current.last));
+            if (current.count == 0) {
+                current.first = segment;
+            } else {
+                AppendVarint(current.stream, segment.l - current.last);
+                AppendVarint(current.stream, segment.r - segment.l);
+            }
+            current.count++;
+            current.last = segment.r;
+        }
+
+        // Returns the contents of the file with all the added segments.
+        std::string Finish() const {
+            std::vector<uint64_t> name_offsets = {0};
+            std::string names;
+            for (const auto* names_list : {&satellite_names, &facility_names}) {
+                for (const auto& name : *names_list) {
+                    names += name;
+                    name_offsets.push_back(names.size());
+                }
+            }
+            long long start = std::numeric_limits<long long>::max();
+            size_t streams_size = 0;
+            for (const auto& list : lists) {
+                if (list.count > 0) {
+                    start = std::min(start, list.first.l);
+                }
+                streams_size += list.stream.size();
+            }
+            start = start == std::numeric_limits<long long>::max() ? 0 : start;
+
+            std::string stream;
+            stream.reserve(streams_size + lists.size() * 3 * 10);
+            for (const auto& type : satellite_types) {
+                AppendVarint(stream, type.filling_speed);
+                AppendVarint(stream, type.freeing_speed);
+                AppendVarint(stream, type.space);
+            }
+            for (const auto& list : lists) {
+                AppendVarint(stream, list.count);
+                if (list.count > 0) {
+                    AppendVarint(stream, list.first.l - start);
+                    AppendVarint(stream, list.first.r - list.first.l);
+                    stream += list.stream;
+                }
+            }
+
+            Header header;
+            memcpy(header.magic, MAGIC, sizeof(MAGIC));
+            header.facilities = facility_names.size();
+            header.satellites = satellite_names.size();
+            header.names_size = names.size();
+            header.start = start;
+            header.stream_size = stream.size();
+            std::string result;
+            result.reserve(sizeof(header) + name_offsets.size() * sizeof(uint64_t) + names.size() + stream.size());
+            result.append(reinterpret_cast<const char*>(&header), sizeof(header));
+            result.append(reinterpret_cast<const char*>(name_offsets.data()), name_offsets.size() * sizeof(uint64_t));
+            result.append(names);
+            result.append(stream);
+            return result;
+        }
+
+    private:
+        struct List {
+            uint64_t count = 0;
+            // The first segment is encoded only in `Finish` since its gap is counted from `start`.
+            Segment first;
+            long long last = 0;
+            // Gaps and lengths of the rest of the segments.
+            std::string stream;
+        };
+
+        const std::vector<std::string>& facility_names;
+        const std::vector<std::string>& satellite_names;
+        const std::vector<SatelliteType>& satellite_types;
+        std::vector<List> lists;
+    };
+
+    // Returns the contents of the binary schedule file.
+    static std::string Encode(const std::vector<std::vector<std::vector<Segment>>>& transmission_segments,
+        const std::vector<std::vector<Segment>>& shooting_segments,
+        const std::vector<std::string>& facility_names,
+        const std::vector<std::string>& satellite_names,
+        const std::vector<SatelliteType>& satellite_types) {
+        int facilities = (int) facility_names.size();
+        int satellites = (int) satellite_names.size();
+        assert((int) transmission_segments.size() == facilities && (int) shooting_segments.size() == satellites);
+        Encoder encoder(facility_names, satellite_names, satellite_types);
+        for (int i = 0; i < facilities; i++) {
+            assert((int) transmission_segments[i].size() == satellites);
+            for (int j = 0; j < satellites; j++) {
+                for (const auto& segment : transmission_segments[i][j]) {
+                    encoder.Add(i * satellites + j, segment);
+                }
+            }
+        }
+        for (int j = 0; j < satellites; j++) {
+            for (const auto& segment : shooting_segments[j]) {
+                encoder.Add(facilities * satellites + j, segment);
+            }
+        }
+        return encoder.Finish();
+    }
+
+    // Reads the schedule from the memory-mapped binary file.
+    // Returns false if the file is missing or malformed.
+    static bool Read(const std::string& filename, Schedule& schedule) {
+        MappedFile file(filename);
+        if (!file.IsValid() || file.size < sizeof(Header)) {
+            return false;
+        }
+        Header header;
+        memcpy(&header, file.data, sizeof(header));
+        if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+            return false;
+        }
+        // Every field is limited by the file size before the sizes are summed, so the sums can't overflow.
+        // Every list takes at least one byte of the stream, so it limits the number of lists as well.
+        if (header.facilities > file.size || header.satellites > file.size || header.names_size > file.size
+            || header.stream_size > file.size || header.facilities >= INT_MAX || header.satellites >= INT_MAX
+            || (header.satellites > 0 && header.facilities + 1 > file.size / header.satellites)) {
+            return false;
+        }
+        uint64_t names_count = header.satellites + header.facilities;
+        if (file.size != sizeof(Header) + (names_count + 1) * sizeof(uint64_t) + header.names_size
+            + header.stream_size) {
+            return false;
+        }
+        std::vector<uint64_t> name_offsets(names_count + 1);
+        memcpy(name_offsets.data(), file.data + sizeof(Header), name_offsets.size() * sizeof(uint64_t));
+        const char* names = file.data + sizeof(Header) + name_offsets.size() * sizeof(uint64_t);
+        if (name_offsets[0] != 0 || name_offsets[names_count] != header.names_size) {
+            return false;
+        }
+        for (uint64_t i = 0; i < names_count; i++) {
+            if (name_offsets[i] > name_offsets[i + 1]) {
+                return false;
+            }
+        }
+        auto get_name = [&](uint64_t i) {
+            return std::string(names + name_offsets[i], names + name_offsets[i + 1]);
+        };
+        int facilities = int(header.facilities);
+        int satellites = int(header.satellites);
+        schedule = Schedule();
+        for (int j = 0; j < satellites; j++) {
+            schedule.satellite_names.push_back(get_name(j));
+        }
+        for (int i = 0; i < facilities; i++) {
+            schedule.facility_names.push_back(get_name(satellites + i));
+        }
+
+        const char* it = names + header.names_size;
+        const char* end = file.end();
+        for (int j = 0; j < satellites; j++) {
+            uint64_t filling_speed;
+            uint64_t freeing_speed;
+            uint64_t space;
+            if (!ReadVarint(it, end, filling_speed) || !ReadVarint(it, end, freeing_speed)
+                || !ReadVarint(it, end, space)) {
+                return false;
+            }
+            schedule.satellite_types.push_back(SatelliteType(-1, "", "", (long long) filling_speed,
+                (long long) freeing_speed, (long long) space));
+        }
+        auto read_list = [&](std::vector<Segment>& segments) {
+            uint64_t count;
+            // Every segment takes at least two bytes.
+            if (!ReadVarint(it, end, count) || count > uint64_t(end - it) / 2) {
+                return false;
+            }
+            segments.reserve(count);
+            long long last = (long long) header.start;
+            for (uint64_t k = 0; k < count; k++) {
+                uint64_t gap;
+                uint64_t length;
+                if (!ReadVarint(it, end, gap) || !ReadVarint(it, end, length)) {
+                    return false;
+                }
+                segments.push_back(Segment(last + (long long) gap, last + (long long) (gap + length)));
+                last = segments.back().r;
+            }
+            return true;
+        };
+        schedule.transmission_segments.assign(facilities, std::vector<std::vector<Segment>>(satellites));
+        schedule.shooting_segments.assign(satellites, std::vector<Segment>());
+        for (int i = 0; i < facilities; i++) {
+            for (int j = 0; j < satellites; j++) {
+                if (!read_list(schedule.transmission_segments[i][j])) {
+                    return false;
+                }
+            }
+        }
+        for (int j = 0; j < satellites; j++) {
+            if (!read_list(schedule.shooting_segments[j])) {
+                return false;
+            }
+        }
+        return it == end;
+    }
+
+private:
+    // Appends `value` as unsigned LEB128: 7 bits per byte, the highest bit marks continuation.
+    static void AppendVarint(std::string& buffer, uint64_t value) {
+        while (value >= 0x80) {
+            buffer.push_back(char(value | 0x80));
+            value >>= 7;
+        }
+        buffer.push_back(char(value));
+    }
+
+    // Reads unsigned LEB128 value and moves `it` past it. Returns false if it's truncated or too long.
+    static bool ReadVarint(const char*& it, const char* end, uint64_t& value) {
+        value = 0;
+        for (int shift = 0; it < end && shift < 64; shift += 7) {
+            uint8_t byte = uint8_t(*it++);
+            value |= uint64_t(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
@@ -0,0 +1,141 @@
+// Receives the schedule while it's being built by the solver instead of the whole `TransmissionResult`
+// afterwards, see `GreedyEventBasedSolver`.
+//
+// Segments are pushed once they are finalized, i.e. the satellite switched to another action
+// and the segment can't be extended anymore. Each satellite does one action at a time,
+// so segments of each satellite are pushed in the order of time, while segments of different
+// satellites are interleaved. Note that it's not true for the segments of each facility:
+// the segment of the satellite is held until its next action, so the later transmission
+// of another satellite to the same facility could be pushed earlier.
+class ScheduleSink {
+public:
+    virtual ~ScheduleSink() = default;
+
+    // Is called once before all segments.
+    virtual void Begin(int /*facilities*/, int /*satellites*/) {}
+    // Pushes transmission of `satellite` to `facility` or photoshooting if `facility` is -1.
+    virtual void Push(int facility, int satellite, const Segment& segment) = 0;
+    // Is called once after all segments.
+    virtual void Finish() {}
+};
+
+// Collects statistics of the pushed schedule.
+class ScheduleStatsSink : public ScheduleSink {
+public:
+    explicit ScheduleStatsSink(const std::vector<SatelliteType>& _satellite_types): satellite_types(_satellite_types) {}
+
+    void Push(int facility, int satellite, const Segment& segment) override {
+        if (facility == -1) {
+            shooting_segments++;
+            shot_data += segment.Length() * satellite_types[satellite].filling_speed;
+        } else {
+            transmission_segments++;
+            total_data += segment.Length() * satellite_types[satellite].freeing_speed;
+        }
+    }
+
+    long long transmission_segments = 0;
+    long long shooting_segments = 0;
+    // Both are stored in 0.001 MiBs.
+    long long total_data = 0;
+    long long shot_data = 0;
+
+private:
+    const std::vector<SatelliteType>& satellite_types;
+};
+
+// Appends pushed segments to the binary file as fixed-size `Record`s in the order of pushing.
+// Records are accumulated in the buffer of the bounded size, which is written with a single `write` call
+// once it's full, so the memory usage doesn't depend on the length of the schedule.
+class SegmentLogSink : public ScheduleSink {
+public:
+    struct Record {
+        // -1 for photoshooting.
+        int32_t facility;
+        int32_t satellite;
+        int64_t l;
+        int64_t r;
+    };
+
+    explicit SegmentLogSink(const std::string& _filename, size_t _buffer_records = 1 << 16):
+        filename(_filename), buffer_records(_buffer_records) {}
+    SegmentLogSink(const SegmentLogSink&) = delete;
+    SegmentLogSink& operator=(const SegmentLogSink&) = delete;
+    ~SegmentLogSink() override {
+        if (fd != -1) {
+            Finish();
+        }
+    }
+
+    void Begin(int /*facilities*/, int /*satellites*/) override {
+        fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+        if (fd == -1) {
+            ExitWithError("open", filename);
+        }
+        buffer.reserve(buffer_records);
+    }
+
+    void Push(int facility, int satellite, const Segment& segment) override {
+        buffer.push_back(Record{facility, satellite, segment.l, segment.r});
+        if (buffer.size() == buffer_records) {
+            Flush();
+        }
+    }
+
+    void Finish() override {
+        Flush();
+        if (close(fd) == -1) {
+            ExitWithError("close", filename);
+        }
+        fd = -1;
+    }
+
+private:
+    void Flush() {
+        WriteAll(fd, reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(Record), filename);
+        buffer.clear();
+    }
+
+    std::string filename;
+    size_t buffer_records;
+    std::vector<Record> buffer;
+    int fd = -1;
+};
+
+// Encodes pushed segments right into the binary schedule file (see `ScheduleFile`), which is written
+// once all segments are pushed. Together with `GreedyEventBasedSolverOptions::record_actions` disabled,
+// the schedule is never stored as `Segment`s, only as the encoded lists taking about 4 bytes per segment.
+class ScheduleFileSink : public ScheduleSink {
+public:
+    ScheduleFileSink(const std::string& _filename, const std::vector<std::string>& _facility_names,
+        const std::vector<std::string>& _satellite_names, const std::vector<SatelliteType>& _satellite_types):
+        filename(_filename), encoder(_facility_names, _satellite_names, _satellite_types),
+        facilities((int) _facility_names.size()), satellites((int) _satellite_names.size()) {}
+
+    void Begin([[maybe_unused]] int solved_facilities, [[maybe_unused]] int solved_satellites) override {
+        assert(solved_facilities == facilities && solved_satellites == satellites);
+    }
+
+    void Push(int facility, int satellite, const Segment& segment) override {
+        // Segments of each list are pushed in the order of time, since segments of each satellite are.
+        encoder.Add((facility == -1 ? facilities : facility) * satellites + satellite, segment);
+    }
+
+    void Finish() override {
+        std::string contents = encoder.Finish();
+        int fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+        if (fd == -1) {
+            ExitWithError("open", filename);
+        }
+        WriteAll(fd, contents.data(), contents.size(), filename);
+        if (close(fd) == -1) {
+            ExitWithError("close", filename);
+        }
+    }
+
+private:
+    std::string filename;
+    ScheduleFile::Encoder encoder;
+    int facilities;
+    int satellites;
+};
@@ -0,0 +1,254 @@
+// Checks the schedule right in memory, without writing and parsing the result files.
+// Works with indices of facilities and satellites, all checks are done by linear sweeps
+// over the sorted segment lists:
+// 1. every transmission (photoshooting) segment lies inside a single visibility segment
+//    of the same facility and satellite (of the same satellite);
+// 2. actions of each satellite don't intersect with each other;
+// 3. transmissions to each facility don't intersect with each other;
+// 4. disk of each satellite is never overflowed and never transmits more data than it has;
+// 5. `total_data` of the result matches the data transmitted by its segments.
+// All found violations are collected into the report instead of stopping at the first one.
+class ScheduleVerifier {
+public:
+    enum class ViolationType {
+        // Segment isn't contained in any visibility segment.
+        OUTSIDE_VISIBILITY,
+        // Segment intersects with the previous action of the same satellite.
+        SATELLITE_OVERLAP,
+        // Segment intersects with the previous transmission to the same facility.
+        FACILITY_OVERLAP,
+        // Disk space is exceeded at the end of the photoshooting segment.
+        DISK_OVERFLOW,
+        // Satellite has less data than it transmitted by the end of the segment.
+        DISK_UNDERFLOW,
+        // `total_data` of the result differs from the recalculated one.
+        TOTAL_DATA_MISMATCH,
+    };
+
+    struct Violation {
+        ViolationType type;
+        // -1 for photoshooting segments and for `TOTAL_DATA_MISMATCH`.
+        int facility;
+        // -1 for `TOTAL_DATA_MISMATCH`.
+        int satellite;
+        Segment segment;
+        // End of the intersected segment for overlaps, amount of data on the disk (in 0.001 MiBs)
+        // for disk violations and the recalculated total data for `TOTAL_DATA_MISMATCH`.
+        long long value;
+    };
+
+    struct Report {
+        // Recalculated total amount of transmitted data.
+        // Is stored in 0.001 MiBs.
+        long long total_data = 0;
+        // Grouped by the checked entity: satellites in the index order, then facilities,
+        // `TOTAL_DATA_MISMATCH` is the last one.
+        std::vector<Violation> violations;
+
+        bool Ok() const {
+            return violations.empty();
+        }
+    };
+
+    ScheduleVerifier(const VisibilityStore& _visibility, const std::vector<SatelliteType>& _satellite_types):
+        visibility(_visibility), satellite_types(_satellite_types) {}
+
+    // Every satellite and every facility is checked by its own task, concurrently if `pool` is provided.
+    // The report doesn't depend on the number of threads.
+    Report Verify(const TransmissionResult& result, ThreadPool* pool = nullptr) const {
+        int facilities = visibility.Facilities();
+        int satellites = visibility.Satellites();
+        assert((int) result.transmission_segments.size() == facilities
+            && (int) result.shooting_segments.size() == satellites);
+        // Reports of the satellites followed by the reports of the facilities.
+        std::vector<Report> entity_reports(satellites + facilities);
+        auto check_entity = [&](int k) {
+            if (k < satellites) {
+                CheckSatellite(result, k, entity_reports[k]);
+            } else {
+                CheckFacility(result, k - satellites, entity_reports[k]);
+            }
+        };
+        if (pool != nullptr) {
+            pool->ParallelFor(satellites + facilities, check_entity);
+        } else {
+            for (int k = 0; k < satellites + facilities; k++) {
+                check_entity(k);
+            }
+        }
+
+        Report report;
+        for (auto& entity_report : entity_reports) {
+            report.total_data += entity_report.total_data;
+            report.violations.insert(report.violations.end(), entity_report.violations.begin(),
+                entity_report.violations.end());
+        }
+        if (report.total_data != result.total_data) {
+            report.violations.push_back({ViolationType::TOTAL_DATA_MISMATCH, -1, -1,
+                Segment(), report.total_data});
+        }
+        return report;
+    }
+
+    // Returns the report in the following format:
+    // {
+    //   "valid": false,
+    //   "total_data": 842453960384,
+    //   "summary": {"outside_visibility": 0, "satellite_overlap": 1, ...},
+    //   "violations": [{"type": "satellite_overlap", "facility": "Anadyr1", "satellite": "KinoSat_110101",
+    //                   "start": "1 Jun 2027 11:24:03.000", "stop": "1 Jun 2027 11:24:14.005",
+    //                   "l": 63947445843000, "r": 63947445854005, "value": 63947445850000}, ...]
+    // }
+    // `facility` is absent for photoshooting segments, both names and times are absent for `TOTAL_DATA_MISMATCH`.
+    static json ToJson(const Report& report, const std::vector<std::string>& facility_names,
+        const std::vector<std::string>& satellite_names) {
+        json summary = json::object();
+        for (int type = 0; type <= (int) ViolationType::TOTAL_DATA_MISMATCH; type++) {
+            summary[TypeName(ViolationType(type))] = 0;
+        }
+        json violations = json::array();
+        TimestampFormatter formatter;
+        char buffer[TimestampFormatter::MAX_LENGTH];
+        for (const auto& violation : report.violations) {
+            summary[TypeName(violation.type)] = summary[TypeName(violation.type)].get<long long>() + 1;
+            json entry = {{"type", TypeName(violation.type)}, {"value", violation.value}};
+            if (violation.facility != -1) {
+                entry["facility"] = facility_names[violation.facility];
+            }
+            if (violation.satellite != -1) {
+                entry["satellite"] = satellite_names[violation.satellite];
+                entry["start"] = std::string(buffer, formatter.Format(violation.segment.l, buffer));
+                entry["stop"] = std::string(buffer, formatter.Format(violation.segment.r, buffer));
+                entry["l"] = violation.segment.l;
+                entry["r"] = violation.segment.r;
+            }
+            violations.push_back(std::move(entry));
+        }
+        return {{"valid", report.Ok()}, {"total_data", report.total_data}, {"summary", summary},
+            {"violations", violations}};
+    }
+
+    static const char* TypeName(ViolationType type) {
+        switch (type) {
+            case ViolationType::OUTSIDE_VISIBILITY:
+                return "outside_visibility";
+            case ViolationType::SATELLITE_OVERLAP:
+                return "satellite_overlap";
+            case ViolationType::FACILITY_OVERLAP:
+                return "facility_overlap";
+            case ViolationType::DISK_OVERFLOW:
+                return "disk_overflow";
+            case ViolationType::DISK_UNDERFLOW:
+                return "disk_underflow";
+            case ViolationType::TOTAL_DATA_MISMATCH:
+                return "total_data_mismatch";
+        }
+        return "";
+    }
+
+private:
+    // Checks the visibility of all segments of the satellite, merges its lists by the left ends of the segments
+    // and checks that actions don't intersect and the disk space stays within its limits.
+    // Lists are merged by scanning all heads since there are only `facilities + 1` of them.
+    void CheckSatellite(const TransmissionResult& result, int satellite, Report& report) const {
+        int facilities = visibility.Facilities();
+        std::vector<const std::vector<Segment>*> lists(facilities + 1);
+        for (int i = 0; i < facilities; i++) {
+            lists[i] = &result.transmission_segments[i][satellite];
+            CheckContained(*lists[i], visibility.Facility(i, satellite), i, satellite, report);
+        }
+        lists[facilities] = &result.shooting_segments[satellite];
+        CheckContained(*lists[facilities], visibility.Satellite(satellite), -1, satellite, report);
+
+        std::vector<int> positions(facilities + 1, 0);
+        // Left end of the current segment of each list, `LLONG_MAX` if the list is over.
+        std::vector<long long> heads_l(facilities + 1);
+        for (int k = 0; k <= facilities; k++) {
+            heads_l[k] = lists[k]->empty() ? LLONG_MAX : (*lists[k])[0].l;
+        }
+        const SatelliteType& type = satellite_types[satellite];
+        long long space = type.space * 1000;
+        long long data = 0;
+        long long last = LLONG_MIN;
+        while (true) {
+            int next = int(std::min_element(heads_l.begin(), heads_l.end()) - heads_l.begin());
+            if (heads_l[next] == LLONG_MAX) {
+                break;
+            }
+            const Segment& segment = (*lists[next])[positions[next]++];
+            heads_l[next] = positions[next] < (int) lists[next]->size() ? (*lists[next])[positions[next]].l
+                : LLONG_MAX;
+            int facility = next == facilities ? -1 : next;
+            if (segment.l < last) {
+                report.violations.push_back({ViolationType::SATELLITE_OVERLAP, facility, satellite, segment, last});
+            }
+            last = std::max(last, segment.r);
+            if (facility == -1) {
+                data += segment.Length() * type.filling_speed;
+                if (data > space) {
+                    report.violations.push_back({ViolationType::DISK_OVERFLOW, facility, satellite, segment, data});
+                }
+            } else {
+                long long transmitted = segment.Length() * type.freeing_speed;
+                data -= transmitted;
+                report.total_data += transmitted;
+                if (data < 0) {
+                    report.violations.push_back({ViolationType::DISK_UNDERFLOW, facility, satellite, segment, data});
+                }
+            }
+        }
+    }
+
+    // Merges transmissions of all satellites to the facility with the heap by the left ends of the segments
+    // and checks that they don't intersect.
+    void CheckFacility(const TransmissionResult& result, int facility, Report& report) const {
+        const auto& facility_segments = result.transmission_segments[facility];
+        int satellites = (int) facility_segments.size();
+        std::vector<int> positions(satellites, 0);
+        std::priority_queue<std::pair<long long, int>, std::vector<std::pair<long long, int>>,
+            std::greater<std::pair<long long, int>>> heads;
+        for (int j = 0; j < satellites; j++) {
+            if (!facility_segments[j].empty()) {
+                heads.push({facility_segments[j][0].l, j});
+            }
+        }
+        long long last = LLONG_MIN;
+        while (!heads.empty()) {
+            int j = heads.top().second;
+            heads.pop();
+            const Segment& segment = facility_segments[j][positions[j]++];
+            if (positions[j] < (int) facility_segments[j].size()) {
+                heads.push({facility_segments[j][positions[j]].l, j});
+            }
+            if (segment.l < last) {
+                report.violations.push_back({ViolationType::FACILITY_OVERLAP, facility, j, segment, last});
+            }
+            last = std::max(last, segment.r);
+        }
+    }
+
+    // Moves the pointer over visibility segments together with the pointer over `segments`,
+    // so the whole list is checked in `O(segments.size() + visibility_segments.size())`.
+    // Unsorted lists are reported as overlaps by the sweeps, here the pointer is just restarted.
+    static void CheckContained(const std::vector<Segment>& segments, const SegmentsView& visibility_segments,
+        int facility, int satellite, Report& report) {
+        int k = 0;
+        long long previous = LLONG_MIN;
+        for (const auto& segment : segments) {
+            if (segment.l < previous) {
+                k = 0;
+            }
+            previous = segment.l;
+            while (k + 1 < visibility_segments.size() && visibility_segments.l[k + 1] <= segment.l) {
+                k++;
+            }
+            if (k >= visibility_segments.size() || segment.l < visibility_segments.l[k]
+                || visibility_segments.r[k] < segment.r) {
+                report.violations.push_back({ViolationType::OUTSIDE_VISIBILITY, facility, satellite, segment, 0});
+            }
+        }
+    }
+
+    const VisibilityStore& visibility;
+    const std::vector<SatelliteType>& satellite_types;
+};
@@ -16,6 +16,10 @@ struct Segment {
         return std::max(0ll, r - l);
     }
 
+    bool operator==(const Segment& other) const {
+        return l == other.l && r == other.r;
+    }
+
     bool operator<(const Segment& other) const {
         if (l != other.l) {
             return l < other.l;
@@ -2,14 +2,15 @@
 // Could be incremental by using actions taken at the previous step.
 class Solver {
 public:
-    // `precalculated_actions` could be empty if this is an initial step of the algorithm
-    // or represent actions taken at the previous step of the algorithm.
+    virtual ~Solver() = default;
+
+    // `previous_result` could be null if this is an initial step of the algorithm
+    // or represent the result of the previous step of the algorithm (its actions and checkpoints).
     // If latter, `selected_iteration` is used 
     // to specify at which iteration mutations are expected.
     virtual TransmissionResult GetTransmissionSchedule(
-        const std::vector<std::vector<std::vector<Segment>>>& facility_visibility,
-        const std::vector<std::vector<Segment>>& satellite_visibility,
+        const VisibilityStore& visibility,
         const std::vector<SatelliteType>& satellite_types,
-        const std::vector<std::vector<int>>& precalculated_actions,
+        const TransmissionResult* previous_result = nullptr,
         int selected_iteration = -1) = 0;
 };
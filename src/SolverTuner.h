@@ -0,0 +1,131 @@
+// Parameters of the solver tuning, see `SolverTuner`.
+struct SolverTuningOptions {
+    // How configurations are chosen.
+    enum class Search {
+        // Tries all combinations of the candidate values.
+        GRID,
+        // Tries `samples` configurations with every parameter distributed uniformly
+        // between its smallest and largest candidate values.
+        RANDOM,
+    };
+
+    // Solver to tune: "event" (`GreedyEventBasedSolver`) or "quantized" (`GreedyQuantizedTimeSolver`).
+    std::string solver = "event";
+    Search search = Search::GRID;
+    // Candidate values of the tuned parameters by their names, which are the names of the fields
+    // of `GreedyEventBasedSolverOptions` or `GreedyQuantizedTimeSolverOptions`.
+    // Parameters which are not listed keep their default values.
+    std::map<std::string, std::vector<double>> parameters;
+    // Used only by `Search::RANDOM`.
+    int samples = 16;
+    unsigned long long seed = 0;
+};
+
+// Solves the problem with different parameters of the greedy solver concurrently on the thread pool
+// to find the best ones for the given visibility data. All runs share the same (read-only) visibility.
+class SolverTuner {
+public:
+    // Parameters of the solver and the amount of data transmitted with them.
+    struct Configuration {
+        std::map<std::string, double> parameters;
+        // Is stored in 0.001 MiBs.
+        long long total_data = 0;
+        // Solving time in millis.
+        long long time = 0;
+    };
+
+    SolverTuner(ThreadPool& _pool, const SolverTuningOptions& _options): pool(_pool), options(_options) {}
+
+    // Returns all tried configurations in the order of generation.
+    std::vector<Configuration> Run(const VisibilityStore& visibility,
+        const std::vector<SatelliteType>& satellite_types) {
+        std::vector<Configuration> configurations = GenerateConfigurations();
+        pool.ParallelFor((int) configurations.size(), [&](int k) {
+            auto start_time = std::chrono::steady_clock::now();
+            std::unique_ptr<Solver> solver = MakeSolver(configurations[k].parameters);
+            configurations[k].total_data = solver->GetTransmissionSchedule(visibility, satellite_types).total_data;
+            configurations[k].time = since(start_time).count();
+        });
+        return configurations;
+    }
+
+    // Returns names of the parameters which could be tuned for the given solver
+    // or an empty list if the solver is unknown. Parameters of the options should be validated
+    // against it before tuning, `MakeSolver` accepts only these names.
+    static std::vector<std::string> ParameterNames(const std::string& solver) {
+        if (solver == "quantized") {
+            return {"space_used_ratio", "future_segments"};
+        }
+        if (solver == "event") {
+            return {"space_used_ratio", "min_segment_length", "min_transmission_length"};
+        }
+        return {};
+    }
+
+    // Creates the solver with the given parameters, the rest of them keep their default values.
+    std::unique_ptr<Solver> MakeSolver(const std::map<std::string, double>& parameters) const {
+        if (options.solver == "quantized") {
+            GreedyQuantizedTimeSolverOptions solver_options;
+            for (const auto& [name, value] : parameters) {
+                if (name == "space_used_ratio") {
+                    solver_options.space_used_ratio = value;
+                } else if (name == "future_segments") {
+                    solver_options.future_segments = (int) std::llround(value);
+                } else {
+                    assert(false && "unknown parameter of the quantized solver");
+                }
+            }
+            return std::make_unique<GreedyQuantizedTimeSolver>(
+                GreedyQuantizedTimeSolver::Stepping::EVERY_QUANTUM, solver_options);
+        }
+        assert(options.solver == "event");
+        GreedyEventBasedSolverOptions solver_options;
+        for (const auto& [name, value] : parameters) {
+            if (name == "space_used_ratio") {
+                solver_options.space_used_ratio = value;
+            } else if (name == "min_segment_length") {
+                solver_options.min_segment_length = std::llround(value);
+            } else if (name == "min_transmission_length") {
+                solver_options.min_transmission_length = std::llround(value);
+            } else {
+                assert(false && "unknown parameter of the event based solver");
+            }
+        }
+        return std::make_unique<GreedyEventBasedSolver>(GreedyEventBasedSolver::Matching::KUHN, solver_options);
+    }
+
+private:
+    std::vector<Configuration> GenerateConfigurations() const {
+        std::vector<Configuration> configurations;
+        if (options.search == SolverTuningOptions::Search::RANDOM) {
+            std::mt19937_64 rng(options.seed);
+            for (int k = 0; k < options.samples; k++) {
+                Configuration configuration;
+                for (const auto& [name, values] : options.parameters) {
+                    assert(!values.empty());
+                    auto [low, high] = std::minmax_element(values.begin(), values.end());
+                    configuration.parameters[name] = std::uniform_real_distribution<double>(*low, *high)(rng);
+                }
+                configurations.push_back(configuration);
+            }
+            return configurations;
+        }
+        // Grid search: the last parameter changes the fastest.
+        configurations.push_back(Configuration());
+        for (const auto& [name, values] : options.parameters) {
+            assert(!values.empty());
+            std::vector<Configuration> extended;
+            for (const auto& configuration : configurations) {
+                for (double value : values) {
+                    extended.push_back(configuration);
+                    extended.back().parameters[name] = value;
+                }
+            }
+            configurations = std::move(extended);
+        }
+        return configurations;
+    }
+
+    ThreadPool& pool;
+    SolverTuningOptions options;
+};
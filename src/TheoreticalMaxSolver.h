@@ -8,22 +8,41 @@
 //    satellites with higher transmission speed. 
 //
 // Please note that this is one of upper boundaries, not necessarily precise or achievable.
+//
+// `Bound::MAX_FLOW` replaces the algorithm with the maximum flow relaxation which also takes into
+// account the disk space and which satellites could see which stations at which time,
+// see `GetMaxFlowBound`. It is much tighter, but slower.
 class TheoreticalMaxSolver : public Solver {
 public:
+    // How the upper bound is calculated.
+    enum class Bound {
+        // Shot data is greedily distributed by the total time of all stations.
+        STATION_TIME,
+        // Maximum flow through the photoshooting and visibility intervals.
+        MAX_FLOW,
+    };
+
+    explicit TheoreticalMaxSolver(Bound _bound = Bound::STATION_TIME): bound(_bound) {}
+
     TransmissionResult GetTransmissionSchedule(
-        const std::vector<std::vector<std::vector<Segment>>>& facility_visibility,
-        const std::vector<std::vector<Segment>>& satellite_visibility,
+        const VisibilityStore& visibility,
         const std::vector<SatelliteType>& satellite_types,
-        const std::vector<std::vector<int>>& precalculated_actions,
+        const TransmissionResult* previous_result = nullptr,
         int selected_iteration = -1) override {
+        if (bound == Bound::MAX_FLOW) {
+            TransmissionResult result(visibility.Facilities(), visibility.Satellites());
+            result.total_data = GetMaxFlowBound(visibility, satellite_types);
+            return result;
+        }
+
         std::vector<long long> satellite_data;
         // Calculates greedily the maximum shooting time.
-        for (int i = 0; i < (int) satellite_visibility.size(); i++) {
+        for (int i = 0; i < visibility.Satellites(); i++) {
             SatelliteType type = satellite_types[i];
             long long filling_time = (type.space * 1000) / type.filling_speed;
             double ratio = double(type.freeing_speed) / double(type.freeing_speed + type.filling_speed);  
             long long total_time = 0;
-            for (const auto& segment: satellite_visibility[i]) {
+            for (const auto& segment: visibility.Satellite(i)) {
                 long long duration = segment.r - segment.l;
                 if (duration <= filling_time) {
                     total_time += duration;
@@ -36,7 +55,7 @@ public:
 
         // Calculates total time that could be used by stations to receive data.
         double total_station_time = 0;
-        for (const auto& facility_satellites : facility_visibility) {
+        for (int f = 0; f < visibility.Facilities(); f++) {
             struct Event {
                 long long x;
                 int type;
@@ -48,8 +67,8 @@ public:
                 }
             };
             std::vector<Event> events;
-            for (const auto& satellite : facility_satellites) {
-                for (const auto& segment : satellite) {
+            for (int i = 0; i < visibility.Satellites(); i++) {
+                for (const auto& segment : visibility.Facility(f, i)) {
                     events.push_back(Event{.x = segment.l, .type = 0});
                     events.push_back(Event{.x = segment.r, .type = 1});
                 }
@@ -73,11 +92,11 @@ public:
         }
 
         // Calculates assign satellites to transmit the data.
-        int facilities = (int) facility_visibility.size();
+        int facilities = visibility.Facilities();
         int satellites = (int) satellite_types.size();
         std::vector<int> perm(satellites);
         iota(perm.begin(), perm.end(), 0);
-        sort(perm.begin(), perm.end(), [&](int i, int j) { 
+        sort(perm.begin(), perm.end(), [&](int i, int j) {
             return satellite_types[i].freeing_speed > satellite_types[j].freeing_speed; });
         TransmissionResult result(facilities, satellites);
         for (int i = 0; i < satellites; i++) {
@@ -95,4 +114,194 @@ public:
 
         return result;
     }
+
+private:
+    // Returns the maximum amount of data which could be transmitted in the flow model similar
+    // to `TimeExpandedFlowSolver`, but coarse enough for the full horizon.
+    //
+    // Flow is measured in millis of transmission. Intervals of each satellite are grouped into
+    // blocks of photoshooting intervals followed by transmission-only intervals: the disk content
+    // only drops during the latter, so the disk space has to be checked once per block, at the end
+    // of its photoshooting intervals. Each block has the shooting node fed by the source (photoshooting)
+    // and the previous block. Data transmitted during the photoshooting intervals (when the station
+    // is visible too) leaves the shooting node before the disk check, by the edge limited by their
+    // transmission time to its own interval node. The rest passes the edge limited by the disk space
+    // to the transmitting node, which passes it to the next block and by the edge limited by the
+    // transmission time of the transmission-only intervals to their interval node.
+    // Interval nodes are connected to station slots (intervals between consecutive events
+    // of the station) by edges limited by the visibility time inside the slot, and slots are
+    // connected to the sink by edges limited by their length. Capacities are rounded up.
+    //
+    // Data is worth `freeing_speed` per unit, so the flow of each satellite is weighted. Amounts
+    // routable from the source edges form a polymatroid, so the weighted optimum is found greedily:
+    // the maximum flow is found for the fastest satellites first and is then augmented by the slower
+    // ones, which never decreases the flow of the faster ones. Only Dinic's algorithm is needed.
+    long long GetMaxFlowBound(const VisibilityStore& visibility, const std::vector<SatelliteType>& satellite_types) {
+        int facilities = visibility.Facilities();
+        int satellites = visibility.Satellites();
+        const int SOURCE = 0;
+        const int SINK = 1;
+        FlowNetwork network(2);
+        auto divide_up = [](long long a, long long b) { return (a + b - 1) / b; };
+
+        // Station slots: intervals between consecutive events of each station.
+        std::vector<std::vector<long long>> facility_times(facilities);
+        std::vector<std::vector<int>> slot_nodes(facilities);
+        for (int f = 0; f < facilities; f++) {
+            for (int i = 0; i < satellites; i++) {
+                SegmentsView segments = visibility.Facility(f, i);
+                facility_times[f].insert(facility_times[f].end(), segments.l, segments.l + segments.size());
+                facility_times[f].insert(facility_times[f].end(), segments.r, segments.r + segments.size());
+            }
+            sort(facility_times[f].begin(), facility_times[f].end());
+            facility_times[f].erase(unique(facility_times[f].begin(), facility_times[f].end()),
+                facility_times[f].end());
+            slot_nodes[f].assign(facility_times[f].size(), -1);
+        }
+        auto get_slot_node = [&](int f, int g) {
+            int& node = slot_nodes[f][g];
+            if (node == -1) {
+                node = network.AddNode();
+                network.AddEdge(node, SINK, facility_times[f][g + 1] - facility_times[f][g]);
+            }
+            return node;
+        };
+
+        // Photoshooting edges (shooting node and capacity) of each satellite,
+        // added to the network by the freeing speed classes.
+        std::vector<std::vector<std::pair<int, long long>>> shooting(satellites);
+        for (int i = 0; i < satellites; i++) {
+            const SatelliteType& type = satellite_types[i];
+            SegmentsView photo = visibility.Satellite(i);
+            std::vector<long long> boundaries(photo.l, photo.l + photo.size());
+            boundaries.insert(boundaries.end(), photo.r, photo.r + photo.size());
+            for (int f = 0; f < facilities; f++) {
+                SegmentsView segments = visibility.Facility(f, i);
+                boundaries.insert(boundaries.end(), segments.l, segments.l + segments.size());
+                boundaries.insert(boundaries.end(), segments.r, segments.r + segments.size());
+            }
+            sort(boundaries.begin(), boundaries.end());
+            boundaries.erase(unique(boundaries.begin(), boundaries.end()), boundaries.end());
+
+            // Current block: the total photoshooting capacity, the total transmission time and
+            // the visibility time inside station slots of the photoshooting intervals (`shooting_`)
+            // and of the transmission-only intervals.
+            long long shooting_capacity = 0;
+            long long shooting_transmission_time = 0;
+            std::vector<std::pair<int, long long>> shooting_slots;
+            long long transmission_time = 0;
+            std::vector<std::pair<int, long long>> slots;
+            // Transmitting node of the previous block.
+            int transmitting = -1;
+            // Connects `from` to the station slots through the interval node limited by `time`.
+            auto add_interval = [&](int from, long long time, std::vector<std::pair<int, long long>>& interval_slots) {
+                int interval = network.AddNode();
+                network.AddEdge(from, interval, time);
+                sort(interval_slots.begin(), interval_slots.end());
+                for (int k = 0; k < (int) interval_slots.size(); k++) {
+                    long long capacity = interval_slots[k].second;
+                    for (; k + 1 < (int) interval_slots.size() && interval_slots[k + 1].first == interval_slots[k].first;
+                        k++) {
+                        capacity += interval_slots[k + 1].second;
+                    }
+                    network.AddEdge(interval, interval_slots[k].first, capacity);
+                }
+                interval_slots.clear();
+            };
+            auto finish_block = [&]() {
+                if (shooting_capacity == 0 && transmission_time == 0) {
+                    return;
+                }
+                long long space = divide_up(type.space * 1000, type.freeing_speed);
+                int shooting_node = network.AddNode();
+                if (transmitting != -1) {
+                    network.AddEdge(transmitting, shooting_node, space);
+                }
+                if (shooting_capacity > 0) {
+                    shooting[i].emplace_back(shooting_node, shooting_capacity);
+                }
+                if (shooting_transmission_time > 0) {
+                    add_interval(shooting_node, shooting_transmission_time, shooting_slots);
+                }
+                transmitting = network.AddNode();
+                network.AddEdge(shooting_node, transmitting, space);
+                if (transmission_time > 0) {
+                    add_interval(transmitting, transmission_time, slots);
+                }
+                shooting_capacity = 0;
+                shooting_transmission_time = 0;
+                transmission_time = 0;
+            };
+
+            // Indices of the first segments which could still intersect the current interval.
+            int photo_iterator = 0;
+            std::vector<int> facility_iterators(facilities);
+            for (int k = 0; k + 1 < (int) boundaries.size(); k++) {
+                long long l = boundaries[k];
+                long long r = boundaries[k + 1];
+                while (photo_iterator < photo.size() && photo.r[photo_iterator] <= l) {
+                    photo_iterator++;
+                }
+                bool shooting_interval = photo_iterator < photo.size() && photo.l[photo_iterator] <= l;
+                if (shooting_interval) {
+                    if (transmission_time > 0) {
+                        finish_block();
+                    }
+                    shooting_capacity += divide_up((r - l) * type.filling_speed, type.freeing_speed);
+                }
+                // Nothing to transmit before the first photoshooting.
+                if (transmitting == -1 && shooting_capacity == 0) {
+                    continue;
+                }
+                bool visible = false;
+                for (int f = 0; f < facilities; f++) {
+                    SegmentsView segments = visibility.Facility(f, i);
+                    int& iterator = facility_iterators[f];
+                    while (iterator < segments.size() && segments.r[iterator] <= l) {
+                        iterator++;
+                    }
+                    if (iterator < segments.size() && segments.l[iterator] <= l) {
+                        visible = true;
+                        const std::vector<long long>& times = facility_times[f];
+                        for (int g = int(upper_bound(times.begin(), times.end(), l) - times.begin()) - 1;
+                            times[g] < r; g++) {
+                            (shooting_interval ? shooting_slots : slots).emplace_back(get_slot_node(f, g),
+                                std::min(r, times[g + 1]) - std::max(l, times[g]));
+                        }
+                    }
+                }
+                if (visible) {
+                    (shooting_interval ? shooting_transmission_time : transmission_time) += r - l;
+                }
+            }
+            finish_block();
+        }
+
+        // Satellites ordered by the freeing speed in the descending order.
+        std::vector<int> perm(satellites);
+        iota(perm.begin(), perm.end(), 0);
+        sort(perm.begin(), perm.end(), [&](int i, int j) {
+            return satellite_types[i].freeing_speed > satellite_types[j].freeing_speed;
+        });
+        std::vector<std::vector<int>> source_edges(satellites);
+        for (int k = 0; k < satellites;) {
+            long long speed = satellite_types[perm[k]].freeing_speed;
+            for (; k < satellites && satellite_types[perm[k]].freeing_speed == speed; k++) {
+                int i = perm[k];
+                for (const auto& [node, capacity] : shooting[i]) {
+                    source_edges[i].push_back(network.AddEdge(SOURCE, node, capacity));
+                }
+            }
+            network.MaxFlow(SOURCE, SINK);
+        }
+        long long total_data = 0;
+        for (int i = 0; i < satellites; i++) {
+            for (int edge : source_edges[i]) {
+                total_data += network.Flow(edge) * satellite_types[i].freeing_speed;
+            }
+        }
+        return total_data;
+    }
+
+    Bound bound;
 };
@@ -0,0 +1,98 @@
+// Simple fixed-size thread pool used to run independent tasks in parallel.
+// The calling thread participates in the work as well, so the pool of size 1
+// has no worker threads at all and runs everything sequentially.
+class ThreadPool {
+public:
+    explicit ThreadPool(int threads = DefaultThreads()) {
+        for (int i = 1; i < threads; i++) {
+            workers.emplace_back([this]() { Work(); });
+        }
+    }
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        wake_up.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    // Returns the number of threads doing the work (including the calling one).
+    int Size() const {
+        return (int) workers.size() + 1;
+    }
+
+    // Returns the number of threads supported by the hardware.
+    static int DefaultThreads() {
+        return std::max(1, (int) std::thread::hardware_concurrency());
+    }
+
+    // Runs `function(i)` for every `i` in [0, tasks) and waits until all of them are finished.
+    // Tasks are distributed dynamically, so there are no guarantees on the execution order.
+    // Must not be called from inside of the running task.
+    template <class F>
+    void ParallelFor(int tasks, const F& function) {
+        if (workers.empty() || tasks <= 1) {
+            for (int i = 0; i < tasks; i++) {
+                function(i);
+            }
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = [&function](int i) { function(i); };
+            total_tasks = tasks;
+            next_task = 0;
+            busy_workers = (int) workers.size();
+            generation++;
+        }
+        wake_up.notify_all();
+        RunTasks();
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [this]() { return busy_workers == 0; });
+        job = nullptr;
+    }
+
+private:
+    // Takes tasks of the current job one by one until there are none left.
+    void RunTasks() {
+        for (int i = next_task++; i < total_tasks; i = next_task++) {
+            job(i);
+        }
+    }
+
+    // Main loop of the worker thread.
+    void Work() {
+        long long seen_generation = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake_up.wait(lock, [&]() { return stop || generation != seen_generation; });
+                if (stop) {
+                    return;
+                }
+                seen_generation = generation;
+            }
+            RunTasks();
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--busy_workers == 0) {
+                finished.notify_one();
+            }
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake_up;
+    std::condition_variable finished;
+    std::function<void(int)> job;
+    std::atomic<int> next_task = 0;
+    int total_tasks = 0;
+    int busy_workers = 0;
+    long long generation = 0;
+    bool stop = false;
+};
@@ -26,6 +26,56 @@ std::vector<int> createPartialYearDays() {
 std::vector<std::string> MONTHS = {"Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
 std::vector<int> DAYS = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
 
+// Returns the number of days between 1 Jan 1970 and the given date in the proleptic Gregorian calendar.
+// `month` and `day` are 1-indexed.
+constexpr long long DaysFromCivil(long long year, int month, int day) {
+    year -= month <= 2;
+    const long long era = (year >= 0 ? year : year - 399) / 400;
+    const long long year_of_era = year - era * 400;
+    const long long day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const long long day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return era * 146097 + day_of_era - 719468;
+}
+
+static_assert(DaysFromCivil(1970, 1, 1) == 0);
+static_assert(DaysFromCivil(2000, 3, 1) == 11017);
+
+// All timestamps are counted from 1 Jan of year 1.
+constexpr long long EPOCH_DAYS = DaysFromCivil(1, 1, 1);
+
+// Packs three characters of the month name into the single key.
+constexpr int MonthKey(char a, char b, char c) {
+    return (int(a) << 16) | (int(b) << 8) | int(c);
+}
+
+// Returns 0-indexed month by its three-letter name or -1 if it's unknown.
+constexpr int MonthIndex(const char* name) {
+    switch (MonthKey(name[0], name[1], name[2])) {
+        case MonthKey('J', 'a', 'n'): return 0;
+        case MonthKey('F', 'e', 'b'): return 1;
+        case MonthKey('M', 'a', 'r'): return 2;
+        case MonthKey('A', 'p', 'r'): return 3;
+        case MonthKey('M', 'a', 'y'): return 4;
+        case MonthKey('J', 'u', 'n'): return 5;
+        case MonthKey('J', 'u', 'l'): return 6;
+        case MonthKey('A', 'u', 'g'): return 7;
+        case MonthKey('S', 'e', 'p'): return 8;
+        case MonthKey('O', 'c', 't'): return 9;
+        case MonthKey('N', 'o', 'v'): return 10;
+        case MonthKey('D', 'e', 'c'): return 11;
+        default: return -1;
+    }
+}
+
+// Returns the number formed by `len` digits starting at `s`.
+constexpr int ParseDigits(const char* s, int len) {
+    int result = 0;
+    for (int i = 0; i < len; i++) {
+        result = result * 10 + (s[i] - '0');
+    }
+    return result;
+}
+
 }
 
 // Helper struct to represent timestamps.
@@ -52,6 +102,36 @@ struct Time {
         return result;
     }
 
+    // Parses timestamp in the fixed format "1 Jun 2027 00:00:01.000" directly from the character range
+    // and returns its numeric value (the same as `ToTimestamp` would return) without any allocations.
+    // Leading spaces are skipped and `it` is moved past the parsed timestamp.
+    static long long ParseTimestamp(const char*& it, const char* end) {
+        // Everything after the day has the fixed layout " Jun 2027 00:00:01.000".
+        const int SUFFIX_LENGTH = 22;
+        int day = ParseNumber(it, end);
+        assert(end - it >= SUFFIX_LENGTH);
+        int month = MonthIndex(it + 1);
+        assert(month != -1);
+        long long days = DaysFromCivil(ParseDigits(it + 5, 4), month + 1, day) - EPOCH_DAYS;
+        long long millis = ParseDigits(it + 10, 2) * 3600000ll + ParseDigits(it + 13, 2) * 60000ll 
+            + ParseDigits(it + 16, 2) * 1000ll + ParseDigits(it + 19, 3);
+        it += SUFFIX_LENGTH;
+        return days * (24 * 3600 * 1000) + millis;
+    }
+
+    // Parses non-negative number skipping leading spaces and moves `it` past it.
+    static int ParseNumber(const char*& it, const char* end) {
+        while (it < end && *it == ' ') {
+            it++;
+        }
+        int result = 0;
+        while (it < end && *it >= '0' && *it <= '9') {
+            result = result * 10 + (*it - '0');
+            it++;
+        }
+        return result;
+    }
+
     // Creates timestamp from the numeric value.
     static Time FromTimestamp(long long timestamp) {
         Time result;
@@ -104,3 +184,79 @@ struct Time {
 };
 
 const std::vector<int> Time::PARTIAL_YEAR_DAYS = createPartialYearDays();
+
+// Formats timestamps in the format "1 Jun 2027 00:00:01.000" (the same as `Time::ToString`)
+// directly into the caller's buffer without allocations. Digits are written in pairs from
+// the lookup table and the date prefix is cached, so consecutive timestamps of the same day
+// don't need `Time::FromTimestamp` at all.
+class TimestampFormatter {
+public:
+    // Maximum length of the formatted timestamp (years have at most 4 digits).
+    static const int MAX_LENGTH = 24;
+
+    // Writes the timestamp to `out` and returns the pointer past its last character.
+    char* Format(long long timestamp, char* out) {
+        long long day = timestamp / DAY_MILLIS;
+        if (day != cached_day) {
+            CacheDate(day);
+        }
+        memcpy(out, prefix, prefix_length);
+        out += prefix_length;
+        int rest = int(timestamp - day * DAY_MILLIS);
+        int millis = rest % 1000;
+        rest /= 1000;
+        out = WritePair(out, rest / 3600);
+        *out++ = ':';
+        out = WritePair(out, rest / 60 % 60);
+        *out++ = ':';
+        out = WritePair(out, rest % 60);
+        *out++ = '.';
+        *out++ = char('0' + millis / 100);
+        return WritePair(out, millis % 100);
+    }
+
+private:
+    // Formats "1 Jun 2027 " prefix of the given day.
+    void CacheDate(long long day) {
+        Time date = Time::FromTimestamp(day * DAY_MILLIS);
+        assert(date.year < 10000);
+        char* out = prefix;
+        if (date.day + 1 >= 10) {
+            out = WritePair(out, date.day + 1);
+        } else {
+            *out++ = char('0' + date.day + 1);
+        }
+        *out++ = ' ';
+        memcpy(out, MONTHS[date.month].data(), 3);
+        out += 3;
+        *out++ = ' ';
+        if (date.year >= 1000) {
+            out = WritePair(out, date.year / 100);
+        } else if (date.year >= 100) {
+            *out++ = char('0' + date.year / 100);
+        }
+        if (date.year >= 10) {
+            out = WritePair(out, date.year % 100);
+        } else {
+            *out++ = char('0' + date.year);
+        }
+        *out++ = ' ';
+        prefix_length = int(out - prefix);
+        cached_day = day;
+    }
+
+    // Writes two digits of `n` < 100.
+    static char* WritePair(char* out, int n) {
+        memcpy(out, DIGIT_PAIRS + 2 * n, 2);
+        return out + 2;
+    }
+
+    static constexpr long long DAY_MILLIS = 24 * 3600 * 1000;
+    static constexpr const char* DIGIT_PAIRS =
+        "0001020304050607080910111213141516171819202122232425262728293031323334353637383940414243444546474849"
+        "5051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
+
+    long long cached_day = -1;
+    char prefix[MAX_LENGTH];
+    int prefix_length = 0;
+};
@@ -0,0 +1,130 @@
+// Calculates the maximum amount of transmitted data in the time-expanded flow model
+// of the problem. Much tighter than `TheoreticalMaxSolver`, but intended for windows
+// of a few hours (see `VisibilityStore::Slice`) to measure how far greedy solvers are from it.
+//
+// Time is split into intervals between consecutive ends of the visibility segments.
+// Data of each satellite is measured in millis needed to transmit it, so the network
+// has no gains:
+// - `source -> disk` edges represent photoshooting (`filling_speed / freeing_speed` units per milli),
+// - `disk -> disk` edges keep the data on the disk between intervals (limited by the disk space),
+// - `disk -> satellite` edges limit the transmission time of the satellite by the interval length
+//   and give the profit of `freeing_speed` per unit,
+// - `satellite -> facility -> sink` edges limit the time of each facility by the interval length.
+// Disk nodes are created only for intervals between events of the satellite itself.
+//
+// The optimal flow is found exactly, but the model is a relaxation: a satellite could do
+// photoshooting and transmission at the same time, intervals are shared fractionally and
+// the disk space is checked only between intervals. So the result is an upper bound,
+// only `total_data` is filled.
+class TimeExpandedFlowSolver : public Solver {
+public:
+    TransmissionResult GetTransmissionSchedule(
+        const VisibilityStore& visibility,
+        const std::vector<SatelliteType>& satellite_types,
+        const TransmissionResult* previous_result = nullptr,
+        int selected_iteration = -1) override {
+        int facilities = visibility.Facilities();
+        int satellites = visibility.Satellites();
+        TransmissionResult result(facilities, satellites);
+        std::vector<long long> times;
+        for (const auto& segment : visibility.All()) {
+            times.push_back(segment.l);
+            times.push_back(segment.r);
+        }
+        sort(times.begin(), times.end());
+        times.erase(unique(times.begin(), times.end()), times.end());
+        if (times.size() < 2) {
+            return result;
+        }
+        int intervals = (int) times.size() - 1;
+
+        // Potentials making all reduced costs non-negative: only `disk -> satellite` edges have costs.
+        long long max_freeing_speed = 0;
+        for (const auto& type : satellite_types) {
+            max_freeing_speed = std::max(max_freeing_speed, type.freeing_speed);
+        }
+        const int SOURCE = 0;
+        const int SINK = 1;
+        FlowNetwork network(2);
+        // Disk and photoshooting capacities are converted to the transmission time and rounded up,
+        // so the flow never undercuts the upper bound.
+        auto divide_up = [](long long a, long long b) { return (a + b - 1) / b; };
+        std::vector<long long> potential = {0, -max_freeing_speed};
+        auto add_node = [&](long long node_potential) {
+            potential.push_back(node_potential);
+            return network.AddNode();
+        };
+        // Node of facility `f` during interval `g` is stored at `f * intervals + g`.
+        std::vector<int> facility_nodes((size_t) facilities * intervals, -1);
+        auto get_facility_node = [&](int f, int g) {
+            int& node = facility_nodes[(size_t) f * intervals + g];
+            if (node == -1) {
+                node = add_node(-max_freeing_speed);
+                network.AddEdge(node, SINK, times[g + 1] - times[g]);
+            }
+            return node;
+        };
+
+        for (int i = 0; i < satellites; i++) {
+            const SatelliteType& type = satellite_types[i];
+            SegmentsView photo = visibility.Satellite(i);
+            std::vector<long long> boundaries(photo.l, photo.l + photo.size());
+            boundaries.insert(boundaries.end(), photo.r, photo.r + photo.size());
+            for (int f = 0; f < facilities; f++) {
+                SegmentsView segments = visibility.Facility(f, i);
+                boundaries.insert(boundaries.end(), segments.l, segments.l + segments.size());
+                boundaries.insert(boundaries.end(), segments.r, segments.r + segments.size());
+            }
+            sort(boundaries.begin(), boundaries.end());
+            boundaries.erase(unique(boundaries.begin(), boundaries.end()), boundaries.end());
+
+            // Indices of the first segments which could still intersect the current interval.
+            int photo_iterator = 0;
+            std::vector<int> facility_iterators(facilities);
+            std::vector<int> visible_facilities;
+            int disk = -1;
+            for (int k = 0; k + 1 < (int) boundaries.size(); k++) {
+                long long l = boundaries[k];
+                long long r = boundaries[k + 1];
+                while (photo_iterator < photo.size() && photo.r[photo_iterator] <= l) {
+                    photo_iterator++;
+                }
+                bool shooting = photo_iterator < photo.size() && photo.l[photo_iterator] <= l;
+                visible_facilities.clear();
+                for (int f = 0; f < facilities; f++) {
+                    SegmentsView segments = visibility.Facility(f, i);
+                    int& iterator = facility_iterators[f];
+                    while (iterator < segments.size() && segments.r[iterator] <= l) {
+                        iterator++;
+                    }
+                    if (iterator < segments.size() && segments.l[iterator] <= l) {
+                        visible_facilities.push_back(f);
+                    }
+                }
+                if (!shooting && visible_facilities.empty()) {
+                    continue;
+                }
+                int next_disk = add_node(0);
+                if (disk != -1) {
+                    network.AddEdge(disk, next_disk, divide_up(type.space * 1000, type.freeing_speed));
+                }
+                disk = next_disk;
+                if (shooting) {
+                    network.AddEdge(SOURCE, disk, divide_up((r - l) * type.filling_speed, type.freeing_speed));
+                }
+                if (!visible_facilities.empty()) {
+                    int satellite = add_node(-type.freeing_speed);
+                    network.AddEdge(disk, satellite, r - l, -type.freeing_speed);
+                    int first = int(lower_bound(times.begin(), times.end(), l) - times.begin());
+                    for (int g = first; g < intervals && times[g] < r; g++) {
+                        for (int f : visible_facilities) {
+                            network.AddEdge(satellite, get_facility_node(f, g), times[g + 1] - times[g]);
+                        }
+                    }
+                }
+            }
+        }
+        result.total_data = -network.MinCostFlow(SOURCE, SINK, std::move(potential));
+        return result;
+    }
+};
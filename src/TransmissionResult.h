@@ -1,3 +1,25 @@
+// Snapshot of the solver state taken before the given iteration.
+// Allows to resume solving from the middle instead of replaying all previous iterations.
+struct SolverCheckpoint {
+    // Index of the iteration which is going to be processed next.
+    long long iteration = 0;
+    // Timestamp at which the iteration starts.
+    long long time = 0;
+    // Total amount of transmitted data before the iteration.
+    long long total_data = 0;
+    // Currently used disk space per satellite.
+    std::vector<long long> space_used;
+    // Solver-specific positions in the visibility data (e.g. iterators over visibility segments).
+    std::vector<int> positions;
+    // Sizes of `transmission_segments` lists (flattened as `facility * satellites + satellite`)
+    // and the right ends of their last segments, which could be extended later.
+    std::vector<int> transmission_counts;
+    std::vector<long long> transmission_last;
+    // Sizes of `shooting_segments` lists and the right ends of their last segments.
+    std::vector<int> shooting_counts;
+    std::vector<long long> shooting_last;
+};
+
 // Class containing the final schedule produced by an algorithm.
 struct TransmissionResult {
     // Total amount of transmitted data.
@@ -10,12 +32,69 @@ struct TransmissionResult {
     // Intervals representing when the photoshotting was active.
     // `shooting_segments[i]` represents all intervals of photoshooting of satellite `i`.
     std::vector<std::vector<Segment>> shooting_segments;
-    // Actions taken by different satellites in each iteration.
-    // `actions[i][j] == facility` if satellite `j` was transmitting data to station `facility`
-    // during iteration `i`. `actions[i][j] == -1` otherwise.
-    std::vector<std::vector<int>> actions;
+    // Actions taken by different satellites in each iteration, see `ActionLog`.
+    ActionLog actions;
+    // Snapshots of the solver state sorted by iteration (could be empty if solver doesn't support them).
+    std::vector<SolverCheckpoint> checkpoints;
 
     TransmissionResult(int facilities, int satellites): 
         transmission_segments(facilities, std::vector<std::vector<Segment>>(satellites)), 
-        shooting_segments(satellites) {}
+        shooting_segments(satellites), actions(satellites) {}
+
+    // Creates checkpoint with the current state of the result.
+    // Solver-specific fields (`space_used` and `positions`) should be filled by the caller.
+    SolverCheckpoint MakeCheckpoint(long long iteration) const {
+        SolverCheckpoint checkpoint;
+        checkpoint.iteration = iteration;
+        checkpoint.total_data = total_data;
+        for (const auto& facility_segments : transmission_segments) {
+            for (const auto& segments : facility_segments) {
+                checkpoint.transmission_counts.push_back((int) segments.size());
+                checkpoint.transmission_last.push_back(segments.empty() ? 0 : segments.back().r);
+            }
+        }
+        for (const auto& segments : shooting_segments) {
+            checkpoint.shooting_counts.push_back((int) segments.size());
+            checkpoint.shooting_last.push_back(segments.empty() ? 0 : segments.back().r);
+        }
+        return checkpoint;
+    }
+
+    // Returns the latest checkpoint taken not after `iteration` or nullptr if there is none.
+    const SolverCheckpoint* FindCheckpoint(long long iteration) const {
+        auto it = upper_bound(checkpoints.begin(), checkpoints.end(), iteration,
+            [](long long value, const SolverCheckpoint& checkpoint) { return value < checkpoint.iteration; });
+        return it == checkpoints.begin() ? nullptr : &*prev(it);
+    }
+
+    // Restores the state of `previous` result as it was at the moment of `checkpoint`.
+    void RestoreCheckpoint(const TransmissionResult& previous, const SolverCheckpoint& checkpoint) {
+        total_data = checkpoint.total_data;
+        auto restore = [](std::vector<Segment>& segments, const std::vector<Segment>& previous_segments,
+            int count, long long last) {
+            segments.assign(previous_segments.begin(), previous_segments.begin() + count);
+            if (count > 0) {
+                segments.back().r = last;
+            }
+        };
+        int satellites = (int) shooting_segments.size();
+        for (int i = 0; i < (int) transmission_segments.size(); i++) {
+            for (int j = 0; j < satellites; j++) {
+                restore(transmission_segments[i][j], previous.transmission_segments[i][j],
+                    checkpoint.transmission_counts[i * satellites + j],
+                    checkpoint.transmission_last[i * satellites + j]);
+            }
+        }
+        for (int i = 0; i < satellites; i++) {
+            restore(shooting_segments[i], previous.shooting_segments[i],
+                checkpoint.shooting_counts[i], checkpoint.shooting_last[i]);
+        }
+        actions = previous.actions.Prefix((int) checkpoint.iteration);
+        checkpoints.clear();
+        for (const auto& previous_checkpoint : previous.checkpoints) {
+            if (previous_checkpoint.iteration < checkpoint.iteration) {
+                checkpoints.push_back(previous_checkpoint);
+            }
+        }
+    }
 };
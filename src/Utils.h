@@ -28,6 +28,27 @@ std::string ToStringWithLength(const std::string& s, int len) {
     return std::string(len - s.size(), ' ') + s;
 }
 
+// Prints the error of the last failed system call made for `filename` and terminates the program.
+[[noreturn]] void ExitWithError(const std::string& action, const std::string& filename) {
+    std::cerr << "Unable to " << action << " " << filename << ": " << strerror(errno) << std::endl;
+    exit(1);
+}
+
+// Writes the whole buffer to the file descriptor, partial and interrupted writes are continued.
+// Terminates the program if writing fails (e.g. the disk is full).
+void WriteAll(int fd, const char* data, size_t size, const std::string& filename) {
+    for (size_t written = 0; written < size;) {
+        ssize_t result = write(fd, data + written, size - written);
+        if (result == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ExitWithError("write", filename);
+        }
+        written += size_t(result);
+    }
+}
+
 template <
     class result_t   = std::chrono::milliseconds,
     class clock_t    = std::chrono::steady_clock,
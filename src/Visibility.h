@@ -0,0 +1,52 @@
+// Indexed representation of all input visibility data.
+// Note that all names are stored separately,
+// we operate with indexed entities to make all operations faster.
+struct Visibility {
+    // `satellite_names[i]` is the name of satellite `i`, sorted lexicographically.
+    std::vector<std::string> satellite_names;
+    // `facility_names[i]` is the name of facility `i`, sorted lexicographically.
+    std::vector<std::string> facility_names;
+    // All facility-satellite and satellite visibility segments.
+    VisibilityStore store;
+
+    // Builds indexed representation from the data parsed by `Reader`.
+    static Visibility FromMaps(
+        const std::map<std::string, std::vector<Segment>>& satellite_visibility_map,
+        const std::map<std::string, std::map<std::string, std::vector<Segment>>>& facility_visibility_map) {
+        Visibility result;
+        std::map<std::string, int> satellite_names_map;
+        std::vector<std::vector<Segment>> satellite_visibility;
+        for (const auto& [name, segments] : satellite_visibility_map) {
+            satellite_names_map[name] = (int) result.satellite_names.size();
+            result.satellite_names.push_back(name);
+            satellite_visibility.push_back(segments);
+        }
+        int satellites = (int) result.satellite_names.size();
+        std::vector<std::vector<std::vector<Segment>>> facility_visibility;
+        for (const auto& [name, satellites_segments] : facility_visibility_map) {
+            std::vector<std::vector<Segment>> segments(satellites);
+            for (const auto& [satellite, satellite_segments] : satellites_segments) {
+                assert(satellite_names_map.count(satellite));
+                segments[satellite_names_map[satellite]] = satellite_segments;
+            }
+            result.facility_names.push_back(name);
+            facility_visibility.push_back(segments);
+        }
+        result.store = VisibilityStore(facility_visibility, satellite_visibility);
+        return result;
+    }
+
+    // Reads visibility data from the text files in the given directories.
+    static Visibility Read(const std::string& facility_path, const std::string& satellite_path,
+        ThreadPool* pool = nullptr) {
+        return FromMaps(Reader::ReadSatelliteVisibility(satellite_path, pool),
+            Reader::ReadFacilityVisibility(facility_path, pool));
+    }
+
+    int Facilities() const {
+        return (int) facility_names.size();
+    }
+    int Satellites() const {
+        return (int) satellite_names.size();
+    }
+};
@@ -0,0 +1,194 @@
+// Helper struct used to store precompiled visibility data in the binary file (.vis),
+// so that the text input doesn't have to be parsed on every run.
+//
+// The file has the following layout (all numbers are stored as 64-bit integers):
+// 1. `Header`.
+// 2. `satellites + facilities + 1` offsets of the names in the names blob
+//    (satellites first, then facilities, both in the index order).
+// 3. Names blob padded with zeros to the multiple of 8 bytes.
+// 4. Description of the input files the cache was compiled from (see `Sources`)
+//    padded with zeros to the multiple of 8 bytes.
+// 5. `facilities * satellites + satellites + 1` offsets of the segment lists in the segments array.
+//    List `i * satellites + j` contains visibility segments of satellite `j` from facility `i`,
+//    list `facilities * satellites + j` contains photoshooting visibility segments of satellite `j`.
+// 6. `l` column of all segments followed by `r` column of all segments.
+struct VisibilityCache {
+    struct Header {
+        char magic[8];
+        uint64_t facilities;
+        uint64_t satellites;
+        uint64_t names_size;
+        // Size of the sources description without padding.
+        uint64_t sources_size;
+        uint64_t segments;
+    };
+    static constexpr char MAGIC[8] = {'S', 'A', 'T', 'V', 'I', 'S', '0', '3'};
+
+    // Returns visibility data using the cache at `cache_path` if it was compiled from exactly
+    // the same input files. Otherwise, parses the input files and recompiles the cache.
+    static Visibility Load(const std::string& cache_path, const std::string& facility_path,
+        const std::string& satellite_path, ThreadPool* pool = nullptr) {
+        Visibility result;
+        std::string sources = Sources({facility_path, satellite_path});
+        if (!sources.empty() && Read(cache_path, result, &sources)) {
+            return result;
+        }
+        result = Visibility::Read(facility_path, satellite_path, pool);
+        if (!Write(cache_path, result, sources)) {
+            std::cerr << "Unable to write visibility cache to " << cache_path << "\n";
+        }
+        return result;
+    }
+
+    // Describes the input files: the absolute path of each directory followed by the name, size
+    // and modification time of each file in it (sorted by name). The cache is valid only for the same description,
+    // so switching to another data set or touching any file invalidates it.
+    // Returns an empty string if any directory can't be listed.
+    static std::string Sources(const std::vector<std::string>& directories) {
+        std::string result;
+        std::error_code error;
+        for (const auto& directory : directories) {
+            result += fs::absolute(directory, error).lexically_normal().string() + "\n";
+            std::vector<std::string> lines;
+            for (const auto& file : fs::directory_iterator(directory, error)) {
+                auto size = file.file_size(error);
+                auto time = file.last_write_time(error);
+                if (error) {
+                    return "";
+                }
+                lines.push_back(file.path().filename().string() + " " + std::to_string(size) + " "
+                    + std::to_string(time.time_since_epoch().count()) + "\n");
+            }
+            if (error) {
+                return "";
+            }
+            sort(lines.begin(), lines.end());
+            for (const auto& line : lines) {
+                result += line;
+            }
+        }
+        return result;
+    }
+
+    // Writes visibility data compiled from the input files described by `sources` into the cache file.
+    // The file is replaced atomically, so concurrent runs never observe a partially written cache.
+    static bool Write(const std::string& cache_path, const Visibility& visibility, const std::string& sources = "") {
+        uint64_t facilities = visibility.Facilities();
+        uint64_t satellites = visibility.Satellites();
+        std::vector<uint64_t> name_offsets = {0};
+        std::string names;
+        for (const auto* names_list : {&visibility.satellite_names, &visibility.facility_names}) {
+            for (const auto& name : *names_list) {
+                names += name;
+                name_offsets.push_back(names.size());
+            }
+        }
+        names.resize((names.size() + 7) / 8 * 8, '\0');
+        std::string padded_sources = sources;
+        padded_sources.resize((sources.size() + 7) / 8 * 8, '\0');
+        const VisibilityStore& store = visibility.store;
+        std::vector<uint64_t> segment_offsets(store.Offsets().begin(), store.Offsets().end());
+
+        Header header;
+        memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.facilities = facilities;
+        header.satellites = satellites;
+        header.names_size = names.size();
+        header.sources_size = sources.size();
+        header.segments = store.Lefts().size();
+
+        std::string temporary_path = cache_path + ".tmp";
+        {
+            std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(name_offsets.data()),
+                std::streamsize(name_offsets.size() * sizeof(uint64_t)));
+            file.write(names.data(), std::streamsize(names.size()));
+            file.write(padded_sources.data(), std::streamsize(padded_sources.size()));
+            file.write(reinterpret_cast<const char*>(segment_offsets.data()),
+                std::streamsize(segment_offsets.size() * sizeof(uint64_t)));
+            for (const auto* column : {&store.Lefts(), &store.Rights()}) {
+                file.write(reinterpret_cast<const char*>(column->data()),
+                    std::streamsize(column->size() * sizeof(long long)));
+            }
+            if (!file) {
+                return false;
+            }
+        }
+        std::error_code error;
+        fs::rename(temporary_path, cache_path, error);
+        return !error;
+    }
+
+    // Reads visibility data from the memory-mapped cache file.
+    // Returns false if the file is missing or malformed or if `expected_sources` is provided
+    // and differs from the sources the cache was compiled from.
+    static bool Read(const std::string& cache_path, Visibility& visibility,
+        const std::string* expected_sources = nullptr) {
+        static_assert(sizeof(long long) == sizeof(uint64_t));
+        MappedFile file(cache_path);
+        if (!file.IsValid() || file.size < sizeof(Header)) {
+            return false;
+        }
+        Header header;
+        memcpy(&header, file.data, sizeof(header));
+        if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+            return false;
+        }
+        // Every field is limited by the file size before the sizes are summed, so the sum can't overflow.
+        if (header.facilities > file.size || header.satellites > file.size || header.names_size > file.size
+            || header.sources_size > file.size || header.segments > file.size
+            || (header.satellites > 0 && header.facilities + 1 > file.size / header.satellites)) {
+            return false;
+        }
+        uint64_t names_count = header.satellites + header.facilities;
+        uint64_t lists_count = (header.facilities + 1) * header.satellites;
+        uint64_t sources_padded_size = (header.sources_size + 7) / 8 * 8;
+        uint64_t expected_size = sizeof(Header) + (names_count + 1) * sizeof(uint64_t) + header.names_size
+            + sources_padded_size + (lists_count + 1) * sizeof(uint64_t) + 2 * header.segments * sizeof(long long);
+        if (file.size != expected_size || header.names_size % 8 != 0) {
+            return false;
+        }
+        const char* it = file.data + sizeof(Header);
+        const uint64_t* name_offsets = reinterpret_cast<const uint64_t*>(it);
+        it += (names_count + 1) * sizeof(uint64_t);
+        const char* names = it;
+        it += header.names_size;
+        if (expected_sources != nullptr && std::string_view(it, header.sources_size) != *expected_sources) {
+            return false;
+        }
+        it += sources_padded_size;
+        const uint64_t* segment_offsets = reinterpret_cast<const uint64_t*>(it);
+        it += (lists_count + 1) * sizeof(uint64_t);
+        const long long* l = reinterpret_cast<const long long*>(it);
+        const long long* r = l + header.segments;
+        if (name_offsets[names_count] > header.names_size || segment_offsets[lists_count] != header.segments) {
+            return false;
+        }
+        for (uint64_t i = 0; i < names_count; i++) {
+            if (name_offsets[i] > name_offsets[i + 1]) {
+                return false;
+            }
+        }
+        for (uint64_t i = 0; i < lists_count; i++) {
+            if (segment_offsets[i] > segment_offsets[i + 1]) {
+                return false;
+            }
+        }
+
+        auto get_name = [&](uint64_t i) {
+            return std::string(names + name_offsets[i], names + name_offsets[i + 1]);
+        };
+        visibility = Visibility();
+        for (uint64_t i = 0; i < header.satellites; i++) {
+            visibility.satellite_names.push_back(get_name(i));
+        }
+        for (uint64_t i = 0; i < header.facilities; i++) {
+            visibility.facility_names.push_back(get_name(header.satellites + i));
+        }
+        visibility.store = VisibilityStore(int(header.facilities), int(header.satellites),
+            std::vector<int>(segment_offsets, segment_offsets + lists_count + 1),
+            std::vector<long long>(l, l + header.segments), std::vector<long long>(r, r + header.segments));
+        return true;
+    }
+};
@@ -0,0 +1,146 @@
+// Read-only view of consecutive visibility segments stored in separate `l` and `r` columns.
+struct SegmentsView {
+    const long long* l = nullptr;
+    const long long* r = nullptr;
+    int count = 0;
+
+    struct Iterator {
+        const SegmentsView* view;
+        int index;
+
+        Segment operator*() const {
+            return (*view)[index];
+        }
+        Iterator& operator++() {
+            index++;
+            return *this;
+        }
+        bool operator!=(const Iterator& other) const {
+            return index != other.index;
+        }
+    };
+
+    int size() const {
+        return count;
+    }
+    bool empty() const {
+        return count == 0;
+    }
+    Segment operator[](int i) const {
+        return Segment(l[i], r[i]);
+    }
+    Iterator begin() const {
+        return Iterator{this, 0};
+    }
+    Iterator end() const {
+        return Iterator{this, count};
+    }
+};
+
+// Columnar storage of all visibility segments.
+// All segments are kept in the single pair of arrays (`l` and `r` columns) grouped into lists
+// with CSR offsets: list `i * satellites + j` contains visibility segments of satellite `j`
+// from facility `i`, list `facilities * satellites + j` contains photoshooting visibility
+// segments of satellite `j`. Segments inside each list are sorted.
+class VisibilityStore {
+public:
+    VisibilityStore() = default;
+
+    // Creates storage from already prepared columns, `offsets` should contain
+    // `(facilities + 1) * satellites + 1` elements.
+    VisibilityStore(int _facilities, int _satellites, std::vector<int> _offsets,
+        std::vector<long long> _l, std::vector<long long> _r):
+        facilities(_facilities), satellites(_satellites),
+        offsets(std::move(_offsets)), l(std::move(_l)), r(std::move(_r)) {
+        assert((int) offsets.size() == (facilities + 1) * satellites + 1);
+        assert(offsets.back() == (int) l.size() && l.size() == r.size());
+    }
+
+    // Creates storage from the nested representation,
+    // `facility_visibility[i][j]` contains segments of satellite `j` from facility `i`.
+    VisibilityStore(const std::vector<std::vector<std::vector<Segment>>>& facility_visibility,
+        const std::vector<std::vector<Segment>>& satellite_visibility):
+        facilities((int) facility_visibility.size()), satellites((int) satellite_visibility.size()) {
+        auto add_segments = [this](const std::vector<Segment>& segments) {
+            std::vector<Segment> sorted_segments = segments;
+            sort(sorted_segments.begin(), sorted_segments.end());
+            for (const auto& segment : sorted_segments) {
+                l.push_back(segment.l);
+                r.push_back(segment.r);
+            }
+            offsets.push_back((int) l.size());
+        };
+        for (const auto& facility_satellites : facility_visibility) {
+            assert((int) facility_satellites.size() == satellites);
+            for (const auto& segments : facility_satellites) {
+                add_segments(segments);
+            }
+        }
+        for (const auto& segments : satellite_visibility) {
+            add_segments(segments);
+        }
+    }
+
+    int Facilities() const {
+        return facilities;
+    }
+    int Satellites() const {
+        return satellites;
+    }
+
+    // Returns visibility segments of `satellite` from `facility`.
+    SegmentsView Facility(int facility, int satellite) const {
+        return List(facility * satellites + satellite);
+    }
+
+    // Returns visibility segments for photoshooting of `satellite`.
+    SegmentsView Satellite(int satellite) const {
+        return List(facilities * satellites + satellite);
+    }
+
+    // Returns all stored segments.
+    SegmentsView All() const {
+        return SegmentsView{l.data(), r.data(), (int) l.size()};
+    }
+
+    // Returns storage with all segments clipped to [from, to), segments outside of it are dropped.
+    VisibilityStore Slice(long long from, long long to) const {
+        std::vector<int> slice_offsets = {0};
+        std::vector<long long> slice_l;
+        std::vector<long long> slice_r;
+        for (int list = 0; list + 1 < (int) offsets.size(); list++) {
+            for (int i = offsets[list]; i < offsets[list + 1]; i++) {
+                if (std::max(l[i], from) < std::min(r[i], to)) {
+                    slice_l.push_back(std::max(l[i], from));
+                    slice_r.push_back(std::min(r[i], to));
+                }
+            }
+            slice_offsets.push_back((int) slice_l.size());
+        }
+        return VisibilityStore(facilities, satellites, std::move(slice_offsets), 
+            std::move(slice_l), std::move(slice_r));
+    }
+
+    // Raw columns, used for serialization.
+    const std::vector<int>& Offsets() const {
+        return offsets;
+    }
+    const std::vector<long long>& Lefts() const {
+        return l;
+    }
+    const std::vector<long long>& Rights() const {
+        return r;
+    }
+
+private:
+    SegmentsView List(int list) const {
+        return SegmentsView{l.data() + offsets[list], r.data() + offsets[list],
+            offsets[list + 1] - offsets[list]};
+    }
+
+    int facilities = 0;
+    int satellites = 0;
+    std::vector<int> offsets = {0};
+    std::vector<long long> l;
+    std::vector<long long> r;
+};
@@ -0,0 +1,231 @@
+// Parameters of the windowed solving, see `WindowedSolver`.
+struct WindowedSolverOptions {
+    // Number of time windows, 0 stands for the size of the thread pool.
+    int windows = 0;
+    // Each window is solved together with `overlap` millis of both neighbouring windows.
+    // Is limited by the half of the window length.
+    long long overlap = 12 * 60 * 60 * 1000;
+};
+
+// Splits the horizon into equal time windows and solves them concurrently on the thread pool.
+//
+// Disk space is the only state coupling the windows, but the greedy solvers never converge
+// to exactly the same disk state when started from different states. So every window is solved
+// from the empty disks on the visibility extended by the overlap with its neighbours, and the
+// results are reconciled afterwards: at each boundary the schedule switches from the previous
+// window to the next one at the moment inside the overlap which maximizes the transmitted data.
+// All satellites switch at the same moment, so transmissions to the same facility never intersect.
+// If the disk of a satellite holds at least as much data in the previous schedule as in the next
+// one at that moment, all transmissions planned by the next window remain feasible and only
+// photoshooting could be trimmed to fit the disk, otherwise the missing data is counted as lost.
+// Finally the disk usage of every satellite is replayed from the start with trimming of
+// the actions that would overflow or drain the disk.
+//
+// The result has no actions, so it can't be used as `previous_result`.
+class WindowedSolver : public Solver {
+public:
+    // `make_solver` creates solver used by a single window,
+    // so solvers never have to be shared between threads.
+    WindowedSolver(ThreadPool& _pool, std::function<std::unique_ptr<Solver>()> _make_solver,
+        const WindowedSolverOptions& _options):
+        pool(_pool), make_solver(std::move(_make_solver)), options(_options) {}
+
+    TransmissionResult GetTransmissionSchedule(
+        const VisibilityStore& visibility,
+        const std::vector<SatelliteType>& satellite_types,
+        const TransmissionResult* previous_result = nullptr,
+        int selected_iteration = -1) override {
+        assert(previous_result == nullptr);
+        long long start = std::numeric_limits<long long>::max();
+        long long end = 0;
+        for (const auto& segment : visibility.All()) {
+            start = std::min(start, segment.l);
+            end = std::max(end, segment.r);
+        }
+        int windows = options.windows > 0 ? options.windows : pool.Size();
+        if (windows <= 1 || end - start < windows) {
+            return make_solver()->GetTransmissionSchedule(visibility, satellite_types);
+        }
+        std::vector<long long> boundaries(windows + 1);
+        for (int k = 0; k <= windows; k++) {
+            boundaries[k] = start + (end - start) * k / windows;
+        }
+        long long overlap = std::min(options.overlap, (end - start) / windows / 2);
+
+        std::vector<TransmissionResult> results(windows, TransmissionResult(0, 0));
+        pool.ParallelFor(windows, [&](int k) {
+            VisibilityStore slice = visibility.Slice(boundaries[k] - overlap, boundaries[k + 1] + overlap);
+            results[k] = make_solver()->GetTransmissionSchedule(slice, satellite_types);
+        });
+
+        int facilities = visibility.Facilities();
+        int satellites = visibility.Satellites();
+        // Actions of each satellite taken from the windows, sorted by time.
+        std::vector<std::vector<Action>> actions(satellites);
+        // Number of satellites switched when they had less data than the next window expected.
+        int deficit_switches = 0;
+        std::vector<std::vector<Action>> previous_actions = CollectActions(results[0], satellite_types);
+        // The moment when the schedule was switched to the current window.
+        long long split = std::numeric_limits<long long>::min();
+        for (int k = 1; k <= windows; k++) {
+            long long next_split = std::numeric_limits<long long>::max();
+            std::vector<std::vector<Action>> next_actions;
+            if (k < windows) {
+                next_actions = CollectActions(results[k], satellite_types);
+                next_split = FindSplit(previous_actions, next_actions, satellite_types,
+                    Segment(boundaries[k] - overlap, boundaries[k] + overlap), boundaries[k], deficit_switches);
+            }
+            for (int i = 0; i < satellites; i++) {
+                for (const auto& action : previous_actions[i]) {
+                    Segment segment(std::max(action.segment.l, split), std::min(action.segment.r, next_split));
+                    if (segment.Length() > 0) {
+                        actions[i].push_back(Action{segment, action.facility});
+                    }
+                }
+            }
+            split = next_split;
+            previous_actions = std::move(next_actions);
+        }
+        results.clear();
+
+        // Replay disk usage, trimming actions which don't fit.
+        int trimmed = 0;
+        TransmissionResult result(facilities, satellites);
+        for (int i = 0; i < satellites; i++) {
+            const SatelliteType& type = satellite_types[i];
+            long long space_used = 0;
+            for (auto& action : actions[i]) {
+                Segment segment = action.segment;
+                if (action.facility == -1) {
+                    segment.r = segment.l + std::min(segment.Length(),
+                        (type.space * 1000 - space_used) / type.filling_speed);
+                    space_used += segment.Length() * type.filling_speed;
+                } else {
+                    segment.r = segment.l + std::min(segment.Length(), space_used / type.freeing_speed);
+                    space_used -= segment.Length() * type.freeing_speed;
+                    result.total_data += segment.Length() * type.freeing_speed;
+                }
+                if (segment.r != action.segment.r) {
+                    trimmed++;
+                }
+                if (segment.Length() > 0) {
+                    InsertSegment(action.facility == -1 ? result.shooting_segments[i]
+                        : result.transmission_segments[action.facility][i], segment);
+                }
+            }
+        }
+        std::cerr << "Windowed solver: " << windows << " windows, " << deficit_switches
+            << " satellites switched with data deficit, " << trimmed << " trimmed segments\n";
+        return result;
+    }
+
+private:
+    // Transmission to `facility` or photoshooting if `facility` is -1.
+    struct Action {
+        Segment segment;
+        int facility;
+        // Used disk space and the total amount of transmitted data before the action
+        // if the schedule is started from the empty disks.
+        long long space_used = 0;
+        long long transmitted = 0;
+    };
+
+    // Returns all actions of each satellite sorted by time.
+    static std::vector<std::vector<Action>> CollectActions(const TransmissionResult& result,
+        const std::vector<SatelliteType>& satellite_types) {
+        int satellites = (int) result.shooting_segments.size();
+        std::vector<std::vector<Action>> actions(satellites);
+        for (int i = 0; i < satellites; i++) {
+            for (const auto& segment : result.shooting_segments[i]) {
+                actions[i].push_back(Action{segment, -1});
+            }
+            for (int f = 0; f < (int) result.transmission_segments.size(); f++) {
+                for (const auto& segment : result.transmission_segments[f][i]) {
+                    actions[i].push_back(Action{segment, f});
+                }
+            }
+            sort(actions[i].begin(), actions[i].end(), [](const Action& a, const Action& b) {
+                return a.segment.l < b.segment.l;
+            });
+            Action last{Segment(0, 0), -1};
+            for (auto& action : actions[i]) {
+                action.space_used = last.space_used;
+                action.transmitted = last.transmitted;
+                last = Advance(action, satellite_types[i], action.segment.r);
+            }
+        }
+        return actions;
+    }
+
+    // Returns `action` with the disk state updated to moment `t` inside the action.
+    static Action Advance(Action action, const SatelliteType& type, long long t) {
+        long long length = std::min(t, action.segment.r) - action.segment.l;
+        if (action.facility == -1) {
+            action.space_used += length * type.filling_speed;
+        } else {
+            action.space_used -= length * type.freeing_speed;
+            action.transmitted += length * type.freeing_speed;
+        }
+        return action;
+    }
+
+    // Returns the disk state (in `space_used` and `transmitted` fields) at moment `t` according to `actions`.
+    static Action GetState(const std::vector<Action>& actions, const SatelliteType& type, long long t) {
+        auto it = upper_bound(actions.begin(), actions.end(), t,
+            [](long long value, const Action& action) { return value < action.segment.l; });
+        return it == actions.begin() ? Action{Segment(0, 0), -1} : Advance(*prev(it), type, t);
+    }
+
+    // Returns the moment inside `range` to switch from `previous` to `next` actions.
+    // Maximizes the data transmitted inside the range by `previous` actions before the moment
+    // and by `next` actions after it, minus the deficit (the amount of data `next` actions
+    // expect to have over the data which `previous` actions left), which is going to be lost.
+    // Moments are considered with `SPLIT_STEP` granularity, ties are resolved by the distance to `target`.
+    // Adds the number of satellites with the deficit at the returned moment to `deficit_switches`.
+    static long long FindSplit(const std::vector<std::vector<Action>>& previous,
+        const std::vector<std::vector<Action>>& next, const std::vector<SatelliteType>& satellite_types,
+        const Segment& range, long long target, int& deficit_switches) {
+        long long best = -1;
+        long long best_score = 0;
+        int best_deficits = 0;
+        auto consider = [&](long long t) {
+            long long score = 0;
+            int deficits = 0;
+            for (int i = 0; i < (int) previous.size(); i++) {
+                Action previous_state = GetState(previous[i], satellite_types[i], t);
+                Action next_state = GetState(next[i], satellite_types[i], t);
+                long long deficit = std::max(0ll, next_state.space_used - previous_state.space_used);
+                score += previous_state.transmitted - next_state.transmitted - deficit;
+                deficits += deficit > 0;
+            }
+            if (best == -1 || score > best_score
+                || (score == best_score && std::abs(t - target) < std::abs(best - target))) {
+                best = t;
+                best_score = score;
+                best_deficits = deficits;
+            }
+        };
+        consider(target);
+        for (long long t = range.l; t <= range.r; t += SPLIT_STEP) {
+            consider(t);
+        }
+        deficit_switches += best_deficits;
+        return best;
+    }
+
+    // Inserts segment to vector and potentially merges it with the previous one.
+    static void InsertSegment(std::vector<Segment>& segments, const Segment& segment) {
+        if (!segments.empty() && segments.back().r == segment.l) {
+            segments.back().r = segment.r;
+        } else {
+            segments.push_back(segment);
+        }
+    }
+
+    // Granularity of the moments considered for switching between windows.
+    static const long long SPLIT_STEP = 60 * 1000;
+
+    ThreadPool& pool;
+    std::function<std::unique_ptr<Solver>()> make_solver;
+    WindowedSolverOptions options;
+};
@@ -22,7 +22,104 @@ struct Writer {
     // Access *       Start Time (UTCG) *        Stop Time (UTCG) * Duration (sec) * Data (Mbytes)
     //      1   1 Jun 2027 11:24:03.000   1 Jun 2027 11:24:14.005           11.005         5634.56
     // ......
-    static void WriteSchedule(const std::string& directory, 
+    //
+    // Every file is formatted into its own preallocated buffer without temporary strings
+    // and written with a single `write` call. Files are processed concurrently on `pool` if it's given.
+    static void WriteSchedule(const std::string& directory,
+        const std::vector<std::vector<std::vector<Segment>>>& transmission_segments,
+        const std::vector<std::vector<Segment>>& shooting_segments,
+        const std::vector<std::string>& facility_names,
+        const std::vector<std::string>& satellite_names,
+        const std::vector<SatelliteType>& satellite_types,
+        ThreadPool* pool = nullptr) {
+        for (const auto& dir : {directory, directory + "Ground/", directory + "Drop/", directory + "Camera/"}) {
+            fs::create_directory(dir);
+        }
+        int facilities = (int) transmission_segments.size();
+        int satellites = (int) shooting_segments.size();
+        // Ground files go first, then Drop and Camera files.
+        auto write_file = [&](int k) {
+            std::string buffer;
+            TimestampFormatter formatter;
+            if (k < facilities) {
+                int i = k;
+                size_t rows = 0;
+                for (int j = 0; j < satellites; j++) {
+                    rows += transmission_segments[i][j].size();
+                }
+                AppendHeader(buffer, facility_names[i], GROUND_COLUMNS, rows * GROUND_ROW_LENGTH);
+                int id = 0;
+                for (int j = 0; j < satellites; j++) {
+                    for (const auto& segment : transmission_segments[i][j]) {
+                        AppendRow(buffer, formatter, ++id, segment, satellite_names[j], 14,
+                            (segment.r - segment.l) * satellite_types[j].freeing_speed);
+                    }
+                }
+                WriteFile(directory + "Ground/Ground_" + facility_names[i] + ".txt", buffer);
+            } else if (k < facilities + satellites) {
+                int j = k - facilities;
+                size_t rows = 0;
+                for (int i = 0; i < facilities; i++) {
+                    rows += transmission_segments[i][j].size();
+                }
+                AppendHeader(buffer, satellite_names[j], DROP_COLUMNS, rows * DROP_ROW_LENGTH);
+                int id = 0;
+                for (int i = 0; i < facilities; i++) {
+                    for (const auto& segment : transmission_segments[i][j]) {
+                        AppendRow(buffer, formatter, ++id, segment, facility_names[i], 12,
+                            (segment.r - segment.l) * satellite_types[j].freeing_speed);
+                    }
+                }
+                WriteFile(directory + "Drop/Drop_" + satellite_names[j] + ".txt", buffer);
+            } else {
+                int i = k - facilities - satellites;
+                AppendHeader(buffer, satellite_names[i], CAMERA_COLUMNS,
+                    shooting_segments[i].size() * CAMERA_ROW_LENGTH);
+                int id = 0;
+                for (const auto& segment : shooting_segments[i]) {
+                    AppendRow(buffer, formatter, ++id, segment, "", 0,
+                        (segment.r - segment.l) * satellite_types[i].filling_speed);
+                }
+                WriteFile(directory + "Camera/Camera_" + satellite_names[i] + ".txt", buffer);
+            }
+        };
+        int files = facilities + 2 * satellites;
+        if (pool != nullptr) {
+            pool->ParallelFor(files, write_file);
+        } else {
+            for (int k = 0; k < files; k++) {
+                write_file(k);
+            }
+        }
+
+        long long total_data = 0;
+        for (int i = 0; i < facilities; i++) {
+            for (int j = 0; j < satellites; j++) {
+                for (const auto& segment : transmission_segments[i][j]) {
+                    total_data += (segment.r - segment.l) * satellite_types[j].freeing_speed;
+                }
+            }
+        }
+        std::cout << "Total written data: " << total_data / 1000 << "." 
+            << ToStringWithLength(total_data % 1000, 3) << "\n";
+    }
+
+    // Writes the schedule into the single binary file `ScheduleFile::FILENAME` inside `directory`,
+    // see `ScheduleFile` for the format.
+    static void WriteBinarySchedule(const std::string& directory,
+        const std::vector<std::vector<std::vector<Segment>>>& transmission_segments,
+        const std::vector<std::vector<Segment>>& shooting_segments,
+        const std::vector<std::string>& facility_names,
+        const std::vector<std::string>& satellite_names,
+        const std::vector<SatelliteType>& satellite_types) {
+        fs::create_directory(directory);
+        WriteFile(directory + ScheduleFile::FILENAME, ScheduleFile::Encode(transmission_segments,
+            shooting_segments, facility_names, satellite_names, satellite_types));
+    }
+
+    // The same as `WriteSchedule`, but formats every row through `std::ofstream` and temporary strings.
+    // Is kept as the reference implementation for benchmarks.
+    static void WriteScheduleStreams(const std::string& directory, 
         const std::vector<std::vector<std::vector<Segment>>>& transmission_segments, 
         const std::vector<std::vector<Segment>>& shooting_segments, 
         const std::vector<std::string>& facility_names, 
@@ -106,4 +203,93 @@ struct Writer {
         std::cout << "Total written data: " << total_data / 1000 << "." 
             << ToStringWithLength(total_data % 1000, 3) << "\n";
     }
+
+private:
+    static constexpr const char* GROUND_COLUMNS = " Access *        Start Time (UTCG) *         Stop Time (UTCG) "
+        "* Duration (sec) * Satellite name * Data (Mbytes)\n";
+    static constexpr const char* DROP_COLUMNS = " Access *        Start Time (UTCG) *         Stop Time (UTCG) "
+        "* Duration (sec) * Station name * Data (Mbytes)\n";
+    static constexpr const char* CAMERA_COLUMNS = " Access *        Start Time (UTCG) *         Stop Time (UTCG) "
+        "* Duration (sec) * Data (Mbytes)\n";
+    // Lengths of the rows (including the separators and the line break) unless some values are wider
+    // than their columns.
+    static const size_t CAMERA_ROW_LENGTH = 7 + 3 + 24 + 3 + 24 + 3 + 14 + 3 + 13 + 1;
+    static const size_t GROUND_ROW_LENGTH = CAMERA_ROW_LENGTH + 14 + 3;
+    static const size_t DROP_ROW_LENGTH = CAMERA_ROW_LENGTH + 12 + 3;
+
+    // Appends the name of the file owner, its underline and the column names,
+    // reserves `rows_length` more characters for the rows.
+    static void AppendHeader(std::string& buffer, const std::string& name, const char* columns, size_t rows_length) {
+        size_t columns_length = strlen(columns);
+        buffer.reserve(2 * (name.size() + 1) + columns_length + rows_length);
+        buffer.append(name).push_back('\n');
+        buffer.append(name.size(), '-').push_back('\n');
+        buffer.append(columns, columns_length);
+    }
+
+    // Appends the row of the access `id` during `segment` with `data` transferred,
+    // `name` column of the given width is skipped if the width is 0.
+    static void AppendRow(std::string& buffer, TimestampFormatter& formatter, int id, const Segment& segment,
+        std::string_view name, int name_width, long long data) {
+        const char* SEPARATOR = "   ";
+        char digits[24];
+        AppendPadded(buffer, FormatNumber(digits + sizeof(digits), id), digits + sizeof(digits), 7);
+        buffer.append(SEPARATOR);
+        char timestamp[TimestampFormatter::MAX_LENGTH];
+        AppendPadded(buffer, timestamp, formatter.Format(segment.l, timestamp), 24);
+        buffer.append(SEPARATOR);
+        AppendPadded(buffer, timestamp, formatter.Format(segment.r, timestamp), 24);
+        buffer.append(SEPARATOR);
+        AppendThousandths(buffer, segment.r - segment.l, 14);
+        buffer.append(SEPARATOR);
+        if (name_width > 0) {
+            AppendPadded(buffer, name.data(), name.data() + name.size(), name_width);
+            buffer.append(SEPARATOR);
+        }
+        AppendThousandths(buffer, data, 13);
+        buffer.push_back('\n');
+    }
+
+    // Writes decimal representation of non-negative `n` with at least `min_digits` digits
+    // (padded with leading zeros) ending at `end`. Returns the pointer to its first character.
+    static char* FormatNumber(char* end, long long n, int min_digits = 1) {
+        char* begin = end;
+        while (n > 0 || end - begin < min_digits) {
+            *--begin = char('0' + n % 10);
+            n /= 10;
+        }
+        return begin;
+    }
+
+    // Appends [begin, end) padded with leading spaces to the length `width`.
+    static void AppendPadded(std::string& buffer, const char* begin, const char* end, int width) {
+        if (end - begin < width) {
+            buffer.append(width - (end - begin), ' ');
+        }
+        buffer.append(begin, end);
+    }
+
+    // Appends `value` thousandths as the decimal fraction with 3 digits after the point
+    // padded with leading spaces to the length `width`.
+    static void AppendThousandths(std::string& buffer, long long value, int width) {
+        char digits[32];
+        char* end = digits + sizeof(digits);
+        char* begin = FormatNumber(end, value % 1000, 3);
+        *--begin = '.';
+        begin = FormatNumber(begin, value / 1000);
+        AppendPadded(buffer, begin, end, width);
+    }
+
+    // Writes the whole buffer to the file, a single `write` call is enough for regular files.
+    // Terminates the program on I/O errors, so the partially written schedule is never reported as done.
+    static void WriteFile(const std::string& filename, const std::string& buffer) {
+        int fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+        if (fd == -1) {
+            ExitWithError("open", filename);
+        }
+        WriteAll(fd, buffer.data(), buffer.size(), filename);
+        if (close(fd) == -1) {
+            ExitWithError("close", filename);
+        }
+    }
 };
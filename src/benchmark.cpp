@@ -0,0 +1,685 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <condition_variable>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <queue>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "lib/json.hpp"
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+#include "Utils.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+#include "Time.h"
+#include "Segment.h"
+#include "VisibilityStore.h"
+#include "SatelliteType.h"
+#include "Reader.h"
+#include "Visibility.h"
+#include "VisibilityCache.h"
+#include "ResultsReader.h"
+#include "ScheduleFile.h"
+#include "Writer.h"
+#include "ActionLog.h"
+#include "TransmissionResult.h"
+#include "Solver.h"
+#include "ScheduleSink.h"
+#include "ScheduleVerifier.h"
+#include "BitsetMatching.h"
+#include "FlowNetwork.h"
+#include "TheoreticalMaxSolver.h"
+#include "TimeExpandedFlowSolver.h"
+#include "GreedyQuantizedTimeSolver.h"
+#include "EventStream.h"
+#include "ActiveEdges.h"
+#include "IncrementalMatching.h"
+#include "GreedyEventBasedSolver.h"
+#include "WindowedSolver.h"
+
+namespace {
+
+// Runs `function` `runs` times and returns the best execution time in millis.
+template <class F>
+long long Measure(int runs, F function) {
+    long long best = std::numeric_limits<long long>::max();
+    for (int i = 0; i < runs; i++) {
+        auto start_time = std::chrono::steady_clock::now();
+        function();
+        best = std::min(best, (long long) since(start_time).count());
+    }
+    return best;
+}
+
+// Compares stream-based and memory-mapped parsers of visibility files.
+void BenchmarkReader(const std::string& directory, int runs) {
+    std::vector<std::string> filenames;
+    for (const auto& file : fs::directory_iterator(directory)) {
+        if (StartsWith(file.path().stem(), "Facility")) {
+            filenames.push_back(file.path());
+        }
+    }
+    sort(filenames.begin(), filenames.end());
+
+    size_t segments = 0;
+    for (const auto& filename : filenames) {
+        auto expected = Reader::ReadFile(filename);
+        auto actual = Reader::ReadFileMapped(filename);
+        assert(expected == actual);
+        for (const auto& [satellite, satellite_segments] : actual.second) {
+            segments += satellite_segments.size();
+        }
+    }
+
+    long long stream_time = Measure(runs, [&]() {
+        for (const auto& filename : filenames) {
+            Reader::ReadFile(filename);
+        }
+    });
+    long long mapped_time = Measure(runs, [&]() {
+        for (const auto& filename : filenames) {
+            Reader::ReadFileMapped(filename);
+        }
+    });
+    std::cout << "Reader (" << filenames.size() << " files, " << segments << " segments):\n"
+        << "  ReadFile:       " << stream_time << "ms\n"
+        << "  ReadFileMapped: " << mapped_time << "ms\n";
+}
+
+
+// Compares sequential and parallel ingestion of the whole visibility directory.
+void BenchmarkParallelReader(const std::string& directory, int runs) {
+    auto expected = Reader::ReadFacilityVisibility(directory);
+    std::cout << "Parallel ingestion (" << expected.size() << " facilities):\n"
+        << "  sequential: " << Measure(runs, [&]() { Reader::ReadFacilityVisibility(directory); }) << "ms\n";
+    for (int threads : {2, 4, ThreadPool::DefaultThreads()}) {
+        ThreadPool pool(threads);
+        // The result must not depend on the number of threads.
+        assert(Reader::ReadFacilityVisibility(directory, &pool) == expected);
+        std::cout << "  " << threads << " threads: " 
+            << Measure(runs, [&]() { Reader::ReadFacilityVisibility(directory, &pool); }) << "ms\n";
+    }
+}
+
+
+// Compares stream-based and fixed-format timestamp parsers.
+void BenchmarkTimeParse(int runs) {
+    const int COUNT = 1000000;
+    // One year of timestamps starting at "1 Jun 2027 00:00:00.000" with pseudorandom steps.
+    long long timestamp = Time{.year = 2027, .month = 5}.ToTimestamp();
+    std::vector<long long> timestamps;
+    std::string buffer;
+    for (int i = 0; i < COUNT; i++) {
+        timestamp += (i * 7919ll) % 63000ll;
+        timestamps.push_back(timestamp);
+        buffer += ToStringWithLength(Time::FromTimestamp(timestamp).ToString(), 24) + " ";
+    }
+
+    std::vector<long long> parsed(COUNT);
+    long long stream_time = Measure(runs, [&]() {
+        std::stringstream stream(buffer);
+        for (int i = 0; i < COUNT; i++) {
+            parsed[i] = Time::Parse(stream).ToTimestamp();
+        }
+    });
+    assert(parsed == timestamps);
+    long long fixed_time = Measure(runs, [&]() {
+        const char* it = buffer.data();
+        for (int i = 0; i < COUNT; i++) {
+            parsed[i] = Time::ParseTimestamp(it, buffer.data() + buffer.size());
+        }
+    });
+    assert(parsed == timestamps);
+    std::cout << "Time parsing (" << COUNT << " timestamps):\n"
+        << "  Parse + ToTimestamp: " << stream_time << "ms\n"
+        << "  ParseTimestamp:      " << fixed_time << "ms\n";
+}
+
+// Compares formatting timestamps with `Time::ToString` and with `TimestampFormatter`.
+void BenchmarkTimeFormat(int runs) {
+    const int COUNT = 1000000;
+    // One year of timestamps starting at "1 Jun 2027 00:00:00.000" with pseudorandom steps.
+    long long timestamp = Time{.year = 2027, .month = 5}.ToTimestamp();
+    std::vector<long long> timestamps;
+    for (int i = 0; i < COUNT; i++) {
+        timestamp += (i * 7919ll) % 63000ll;
+        timestamps.push_back(timestamp);
+    }
+
+    std::string expected;
+    long long string_time = Measure(runs, [&]() {
+        expected.clear();
+        for (long long timestamp : timestamps) {
+            expected += Time::FromTimestamp(timestamp).ToString();
+        }
+    });
+    std::string formatted;
+    long long formatter_time = Measure(runs, [&]() {
+        formatted.clear();
+        TimestampFormatter formatter;
+        char buffer[TimestampFormatter::MAX_LENGTH];
+        for (long long timestamp : timestamps) {
+            formatted.append(buffer, formatter.Format(timestamp, buffer));
+        }
+    });
+    assert(formatted == expected);
+    std::cout << "Time formatting (" << COUNT << " timestamps):\n"
+        << "  FromTimestamp + ToString: " << string_time << "ms\n"
+        << "  TimestampFormatter:       " << formatter_time << "ms\n";
+}
+
+// Compares reading visibility data from the text files and from the binary cache.
+void BenchmarkVisibilityCache(const std::string& cache_path, const std::string& facility_path,
+    const std::string& satellite_path, int runs) {
+    Visibility expected = Visibility::Read(facility_path, satellite_path);
+    std::string sources = VisibilityCache::Sources({facility_path, satellite_path});
+    bool written = VisibilityCache::Write(cache_path, expected, sources);
+    assert(written);
+    Visibility actual;
+    // Cache compiled from other files is rejected.
+    std::string other_sources = sources + "other\n";
+    bool read_other = VisibilityCache::Read(cache_path, actual, &other_sources);
+    bool read = VisibilityCache::Read(cache_path, actual, &sources);
+    assert(!read_other && read);
+    assert(actual.satellite_names == expected.satellite_names);
+    assert(actual.facility_names == expected.facility_names);
+    assert(actual.store.Offsets() == expected.store.Offsets());
+    assert(actual.store.Lefts() == expected.store.Lefts());
+    assert(actual.store.Rights() == expected.store.Rights());
+    std::cout << "Visibility loading:\n"
+        << "  text files: " << Measure(runs, [&]() { Visibility::Read(facility_path, satellite_path); }) << "ms\n"
+        << "  cache:      " << Measure(runs, [&]() { VisibilityCache::Read(cache_path, actual); }) << "ms\n";
+}
+
+
+// Compares materializing and sorting all events with merging them lazily by `EventStream`.
+void BenchmarkEvents(const Visibility& visibility) {
+    const VisibilityStore& store = visibility.store;
+    auto sort_events = [&store]() {
+        std::vector<Event> events;
+        for (int i = 0; i < store.Facilities(); i++) {
+            for (int j = 0; j < store.Satellites(); j++) {
+                for (const auto& segment : store.Facility(i, j)) {
+                    events.push_back(Event{.x = segment.l, .end_x = segment.r, .type = 1, .facility = i, .satellite = j});
+                    events.push_back(Event{.x = segment.r, .type = 0, .facility = i, .satellite = j});
+                }
+            }
+        }
+        for (int j = 0; j < store.Satellites(); j++) {
+            for (const auto& segment : store.Satellite(j)) {
+                events.push_back(Event{.x = segment.l, .end_x = segment.r, .type = 1, .facility = -1, .satellite = j});
+                events.push_back(Event{.x = segment.r, .type = 0, .facility = -1, .satellite = j});
+            }
+        }
+        sort(events.begin(), events.end());
+        return events;
+    };
+    std::vector<Event> sorted_events = sort_events();
+    auto drain = [&store](EventStream::Source source) {
+        EventStream stream(store, source);
+        while (!stream.Empty()) {
+            stream.Pop();
+        }
+    };
+    std::cout << "Events (" << sorted_events.size() << "):\n"
+        << "  Event + std::sort:         " << Measure(3, [&]() { sort_events(); }) << "ms, "
+        << sorted_events.size() * sizeof(Event) / 1024 << " KiB\n";
+    for (auto [name, source] : {std::make_pair("PackedEvent + radix sort:  ", EventStream::Source::SORTED),
+        std::make_pair("heap merge:                ", EventStream::Source::MERGED)}) {
+        EventStream stream(store, source);
+        for (const auto& event : sorted_events) {
+            Event streamed = stream.Pop();
+            assert(!(event < streamed) && !(streamed < event) && event.end_x == streamed.end_x);
+        }
+        assert(stream.Empty());
+        std::cout << "  " << name << Measure(3, [&]() { drain(source); }) << "ms";
+        if (source == EventStream::Source::SORTED) {
+            std::cout << ", " << sorted_events.size() * sizeof(PackedEvent) / 1024 << " KiB";
+        }
+        std::cout << "\n";
+    }
+}
+
+// Compares matching algorithms of the event-based solver: the time and the number of satellites
+// whose edges were scanned, which is counted the same way for all of them.
+void BenchmarkMatching(const Visibility& visibility, const std::vector<SatelliteType>& satellite_types) {
+    std::cout << "Event-based solver matching:\n";
+    for (auto [name, matching] : {std::make_pair("Kuhn (bitset)", GreedyEventBasedSolver::Matching::KUHN),
+        std::make_pair("Kuhn (lists) ", GreedyEventBasedSolver::Matching::KUHN_LISTS),
+        std::make_pair("incremental  ", GreedyEventBasedSolver::Matching::INCREMENTAL)}) {
+        GreedyEventBasedSolver solver(matching);
+        auto start_time = std::chrono::steady_clock::now();
+        TransmissionResult result = solver.GetTransmissionSchedule(visibility.store, satellite_types);
+        long long time = since(start_time).count();
+        std::cout << "  " << name << ": " << time << "ms, " << result.actions.Size() << " iterations, "
+            << double(solver.MatchingExpansions()) / double(result.actions.Size()) << " expanded satellites per iteration, "
+            << "total data " << result.total_data / 1000 << " MiB\n";
+    }
+}
+
+// Compares stepping modes of the quantized solver, results should be identical.
+void BenchmarkQuantizedStepping(const Visibility& visibility, const std::vector<SatelliteType>& satellite_types) {
+    std::cout << "Quantized solver stepping:\n";
+    std::vector<TransmissionResult> results;
+    for (auto [name, stepping] : {
+        std::make_pair("every quantum", GreedyQuantizedTimeSolver::Stepping::EVERY_QUANTUM),
+        std::make_pair("skip quiet   ", GreedyQuantizedTimeSolver::Stepping::SKIP_QUIET)}) {
+        GreedyQuantizedTimeSolver solver(stepping);
+        auto start_time = std::chrono::steady_clock::now();
+        results.push_back(solver.GetTransmissionSchedule(visibility.store, satellite_types));
+        std::cout << "  " << name << ": " << since(start_time).count() << "ms, total data " 
+            << results.back().total_data / 1000 << " MiB\n";
+    }
+    assert(results[0].total_data == results[1].total_data);
+    assert(results[0].transmission_segments == results[1].transmission_segments);
+    assert(results[0].shooting_segments == results[1].shooting_segments);
+}
+
+// Compares greedy solver with the upper bounds on short time windows.
+void BenchmarkFlowGap(const Visibility& visibility, const std::vector<SatelliteType>& satellite_types) {
+    const long long WINDOW_LENGTH = 3 * 60 * 60 * 1000;
+    const long long DAY = 24 * 60 * 60 * 1000;
+    // Photoshooting is possible only during the first half of each day in the test data.
+    const long long WINDOW_OFFSET = 4 * 60 * 60 * 1000;
+    long long start = std::numeric_limits<long long>::max();
+    for (const auto& segment : visibility.store.All()) {
+        start = std::min(start, segment.l);
+    }
+    std::cout << "Greedy gap on 3h windows (greedy / flow bound / theoretical max):\n";
+    for (int day : {1, 4, 7, 10}) {
+        long long window_start = start + day * DAY + WINDOW_OFFSET;
+        VisibilityStore window = visibility.store.Slice(window_start, window_start + WINDOW_LENGTH);
+        GreedyEventBasedSolver greedy_solver;
+        TimeExpandedFlowSolver flow_solver;
+        TheoreticalMaxSolver max_solver;
+        long long greedy = greedy_solver.GetTransmissionSchedule(window, satellite_types).total_data;
+        auto start_time = std::chrono::steady_clock::now();
+        long long bound = flow_solver.GetTransmissionSchedule(window, satellite_types).total_data;
+        long long flow_time = since(start_time).count();
+        long long max = max_solver.GetTransmissionSchedule(window, satellite_types).total_data;
+        std::cout << "  day " << day << ": " << greedy / 1000 << " / " << bound / 1000 << " / " << max / 1000
+            << " MiB, gap " << 100. * double(bound - greedy) / double(bound) << "%, flow " << flow_time << "ms\n";
+    }
+}
+
+// Compares sequential solving with solving of time windows in parallel.
+void BenchmarkWindows(const Visibility& visibility, const std::vector<SatelliteType>& satellite_types) {
+    ThreadPool pool;
+    std::cout << "Time windows (" << pool.Size() << " threads):\n";
+    for (int windows : {1, 4, 8}) {
+        WindowedSolverOptions options;
+        options.windows = windows;
+        WindowedSolver solver(pool, []() { return std::make_unique<GreedyEventBasedSolver>(); }, options);
+        auto start_time = std::chrono::steady_clock::now();
+        TransmissionResult result = solver.GetTransmissionSchedule(visibility.store, satellite_types);
+        std::cout << "  " << windows << " windows: " << since(start_time).count() << "ms, total data "
+            << result.total_data / 1000 << " MiB\n";
+    }
+}
+
+// Compares compact action log with storing the full row of actions for every iteration.
+void BenchmarkActionLog(const Visibility& visibility, const std::vector<SatelliteType>& satellite_types) {
+    GreedyEventBasedSolver solver;
+    TransmissionResult result = solver.GetTransmissionSchedule(visibility.store, satellite_types);
+    const ActionLog& actions = result.actions;
+    // Sequential reading should agree with the random access.
+    ActionLog::Cursor cursor(&actions, 0);
+    for (int i = 0; i < actions.Size(); i++, cursor.Next()) {
+        if (i % 997 == 0) {
+            assert(cursor.Row() == actions.Get(i));
+        }
+    }
+    size_t full_size = size_t(actions.Size()) * visibility.Satellites() * sizeof(int);
+    std::cout << "Action log (" << actions.Size() << " iterations):\n"
+        << "  full rows:       " << full_size / 1024 << " KiB\n"
+        << "  compact log:     " << actions.MemoryUsage() / 1024 << " KiB\n"
+        << "  sequential read: " << Measure(3, [&]() {
+            ActionLog::Cursor cursor(&actions, 0);
+            for (int i = 0; i < actions.Size(); i++) {
+                cursor.Next();
+            }
+        }) << "ms\n";
+}
+
+void BenchmarkMaxBounds(const Visibility& visibility, const std::vector<SatelliteType>& satellite_types) {
+    // Both bounds must be at least the data of the valid greedy schedule.
+    auto check_bounds = [](const VisibilityStore& store, const std::vector<SatelliteType>& types, bool print) {
+        TransmissionResult greedy = GreedyEventBasedSolver().GetTransmissionSchedule(store, types);
+        assert(ScheduleVerifier(store, types).Verify(greedy).Ok());
+        for (auto bound : {TheoreticalMaxSolver::Bound::STATION_TIME, TheoreticalMaxSolver::Bound::MAX_FLOW}) {
+            TheoreticalMaxSolver solver(bound);
+            auto start = std::chrono::steady_clock::now();
+            long long total_data = solver.GetTransmissionSchedule(store, types).total_data;
+            assert(total_data >= greedy.total_data);
+            if (print) {
+                std::cout << "Theoretical max (" << (bound == TheoreticalMaxSolver::Bound::MAX_FLOW ? "max flow"
+                    : "station time") << "): " << total_data / 1000 << " MiB, " << since(start).count() << "ms\n";
+            }
+        }
+    };
+    // The satellite sees the station for the whole photoshooting window,
+    // so its small disk is freed and refilled many times during it.
+    check_bounds(VisibilityStore({{{Segment(10000, 1010000)}}}, {{Segment(0, 1010000)}}),
+        {SatelliteType(0, "SmallDisk", ".*", 512, 128, 1000)}, false);
+    check_bounds(visibility.store, satellite_types, true);
+}
+
+void BenchmarkScheduleSink(const Visibility& visibility, const std::vector<SatelliteType>& satellite_types) {
+    TransmissionResult result(0, 0);
+    long long result_time = Measure(1, [&]() {
+        result = GreedyEventBasedSolver().GetTransmissionSchedule(visibility.store, satellite_types);
+    });
+    long long segments = 0;
+    for (const auto& facility_segments : result.transmission_segments) {
+        for (const auto& list : facility_segments) {
+            segments += (long long) list.size();
+        }
+    }
+    for (const auto& list : result.shooting_segments) {
+        segments += (long long) list.size();
+    }
+
+    ScheduleStatsSink stats(satellite_types);
+    long long stats_time = Measure(1, [&]() {
+        GreedyEventBasedSolver solver(GreedyEventBasedSolver::Matching::KUHN, {}, &stats);
+        solver.GetTransmissionSchedule(visibility.store, satellite_types);
+    });
+    assert(stats.total_data == result.total_data && stats.transmission_segments + stats.shooting_segments == segments);
+
+    // Segments logged to the file are grouped back into lists to compare them with the result.
+    std::string log_path = (fs::temp_directory_path() / "segments.log").string();
+    long long log_time = Measure(1, [&]() {
+        SegmentLogSink log(log_path);
+        GreedyEventBasedSolver solver(GreedyEventBasedSolver::Matching::KUHN, {}, &log);
+        solver.GetTransmissionSchedule(visibility.store, satellite_types);
+    });
+    TransmissionResult logged(visibility.Facilities(), visibility.Satellites());
+    {
+        MappedFile file(log_path);
+        assert(file.size == segments * sizeof(SegmentLogSink::Record));
+        const auto* records = reinterpret_cast<const SegmentLogSink::Record*>(file.data);
+        for (size_t k = 0; k < file.size / sizeof(SegmentLogSink::Record); k++) {
+            const auto& record = records[k];
+            (record.facility == -1 ? logged.shooting_segments[record.satellite]
+                : logged.transmission_segments[record.facility][record.satellite]).push_back(
+                Segment(record.l, record.r));
+        }
+    }
+    fs::remove(log_path);
+    assert(logged.transmission_segments == result.transmission_segments
+        && logged.shooting_segments == result.shooting_segments);
+
+    // Streamed binary schedule without the action log must match the one encoded from the result.
+    std::string schedule_file_path = (fs::temp_directory_path() / "schedule.sch").string();
+    TransmissionResult streamed(0, 0);
+    long long schedule_file_time = Measure(1, [&]() {
+        ScheduleFileSink schedule_file(schedule_file_path, visibility.facility_names, visibility.satellite_names,
+            satellite_types);
+        GreedyEventBasedSolverOptions options;
+        options.record_actions = false;
+        GreedyEventBasedSolver solver(GreedyEventBasedSolver::Matching::KUHN, options, &schedule_file);
+        streamed = solver.GetTransmissionSchedule(visibility.store, satellite_types);
+    });
+    {
+        MappedFile file(schedule_file_path);
+        std::string expected = ScheduleFile::Encode(result.transmission_segments, result.shooting_segments,
+            visibility.facility_names, visibility.satellite_names, satellite_types);
+        [[maybe_unused]] bool same = std::string_view(file.data, file.size) == expected;
+        assert(same && streamed.total_data == result.total_data && streamed.actions.Size() == 0);
+    }
+    fs::remove(schedule_file_path);
+    std::cout << "Schedule sinks (" << segments << " segments, "
+        << segments * (long long) sizeof(Segment) / 1024 << " KiB buffered in the result):\n"
+        << "  TransmissionResult:  " << result_time << "ms\n"
+        << "  ScheduleStatsSink:   " << stats_time << "ms\n"
+        << "  SegmentLogSink:      " << log_time << "ms\n"
+        << "  ScheduleFileSink:    " << schedule_file_time << "ms (without the action log)\n";
+}
+
+void BenchmarkWriter(const Visibility& visibility, const std::vector<SatelliteType>& satellite_types) {
+    GreedyEventBasedSolver solver;
+    TransmissionResult result = solver.GetTransmissionSchedule(visibility.store, satellite_types);
+    std::string streams_directory = (fs::temp_directory_path() / "schedule_streams").string() + "/";
+    std::string buffers_directory = (fs::temp_directory_path() / "schedule_buffers").string() + "/";
+    ThreadPool pool;
+    long long streams_time = Measure(1, [&]() {
+        Writer::WriteScheduleStreams(streams_directory, result.transmission_segments, result.shooting_segments,
+            visibility.facility_names, visibility.satellite_names, satellite_types);
+    });
+    long long buffers_time = Measure(1, [&]() {
+        Writer::WriteSchedule(buffers_directory, result.transmission_segments, result.shooting_segments,
+            visibility.facility_names, visibility.satellite_names, satellite_types);
+    });
+    long long parallel_time = Measure(1, [&]() {
+        Writer::WriteSchedule(buffers_directory, result.transmission_segments, result.shooting_segments,
+            visibility.facility_names, visibility.satellite_names, satellite_types, &pool);
+    });
+    long long binary_time = Measure(1, [&]() {
+        Writer::WriteBinarySchedule(buffers_directory, result.transmission_segments, result.shooting_segments,
+            visibility.facility_names, visibility.satellite_names, satellite_types);
+    });
+    Schedule schedule;
+    bool read = false;
+    long long binary_read_time = Measure(1, [&]() {
+        read = ScheduleFile::Read(buffers_directory + ScheduleFile::FILENAME, schedule);
+    });
+    assert(read && schedule.transmission_segments == result.transmission_segments
+        && schedule.shooting_segments == result.shooting_segments);
+    size_t binary_size = fs::file_size(buffers_directory + ScheduleFile::FILENAME);
+    fs::remove(buffers_directory + ScheduleFile::FILENAME);
+    long long text_read_time = Measure(1, [&]() {
+        ResultsReader::ReadDropFiles(buffers_directory + "Drop/");
+        ResultsReader::ReadCameraFiles(buffers_directory + "Camera/");
+    });
+
+    size_t total_size = 0;
+    for (const auto& entry : fs::recursive_directory_iterator(buffers_directory)) {
+        if (entry.is_regular_file()) {
+            MappedFile buffers_file(entry.path().string());
+            MappedFile streams_file(streams_directory + fs::relative(entry.path(), buffers_directory).string());
+            assert(buffers_file.size == streams_file.size
+                && std::equal(buffers_file.begin(), buffers_file.end(), streams_file.begin()));
+            total_size += buffers_file.size;
+        }
+    }
+    fs::remove_all(streams_directory);
+    fs::remove_all(buffers_directory);
+    std::cout << "Schedule writing (" << (total_size >> 20) << " MiB):\n"
+        << "  ofstream:                  " << streams_time << "ms\n"
+        << "  buffers:                   " << buffers_time << "ms\n"
+        << "  buffers, " << pool.Size() << " threads:        " << parallel_time << "ms\n"
+        << "Binary schedule (" << (binary_size >> 10) << " KiB):\n"
+        << "  write:                     " << binary_time << "ms\n"
+        << "  read:                      " << binary_read_time << "ms\n"
+        << "  read text (ResultsReader): " << text_read_time << "ms\n";
+}
+
+// Compares in-memory `ScheduleVerifier` with the checks of `verifier` (string-keyed maps,
+// binary search of each segment and sorting of the actions) applied to the same result,
+// then checks that broken copies of the result are reported.
+void BenchmarkScheduleVerifier(const Visibility& visibility, const std::vector<SatelliteType>& satellite_types,
+    int runs) {
+    TransmissionResult result = GreedyEventBasedSolver().GetTransmissionSchedule(visibility.store, satellite_types);
+    ScheduleVerifier verifier(visibility.store, satellite_types);
+    ScheduleVerifier::Report report;
+    long long sweep_time = Measure(runs, [&]() { report = verifier.Verify(result); });
+    assert(report.Ok() && report.total_data == result.total_data);
+    ThreadPool pool;
+    long long parallel_time = Measure(runs, [&]() { report = verifier.Verify(result, &pool); });
+    assert(report.Ok() && report.total_data == result.total_data);
+
+    long long maps_total_data = 0;
+    long long maps_time = Measure(runs, [&]() {
+        std::map<std::string, int> satellite_names_map;
+        for (int j = 0; j < visibility.Satellites(); j++) {
+            satellite_names_map[visibility.satellite_names[j]] = j;
+        }
+        std::map<std::string, std::vector<std::pair<Segment, int>>> action_segments;
+        auto add_segments = [&](const std::vector<Segment>& segments, const SegmentsView& visibility_segments,
+            const std::string& facility, const std::string& satellite) {
+            for (const auto& segment : segments) {
+                if (!facility.empty()) {
+                    action_segments[facility].push_back(std::make_pair(segment, 1));
+                }
+                action_segments[satellite].push_back(std::make_pair(segment, facility.empty() ? 0 : 1));
+                const long long* it = std::upper_bound(visibility_segments.l,
+                    visibility_segments.l + visibility_segments.size(), segment.l);
+                int ind = int(it - visibility_segments.l) - 1;
+                assert(ind >= 0 && segment.r <= visibility_segments.r[ind]);
+            }
+        };
+        for (int i = 0; i < visibility.Facilities(); i++) {
+            for (int j = 0; j < visibility.Satellites(); j++) {
+                add_segments(result.transmission_segments[i][j], visibility.store.Facility(i, j),
+                    visibility.facility_names[i], visibility.satellite_names[j]);
+            }
+        }
+        for (int j = 0; j < visibility.Satellites(); j++) {
+            add_segments(result.shooting_segments[j], visibility.store.Satellite(j), "", visibility.satellite_names[j]);
+        }
+        maps_total_data = 0;
+        for (auto& [name, segments] : action_segments) {
+            sort(segments.begin(), segments.end());
+            for (int k = 0; k + 1 < (int) segments.size(); k++) {
+                assert(!segments[k].first.Intersects(segments[k + 1].first));
+            }
+            auto it = satellite_names_map.find(name);
+            if (it == satellite_names_map.end()) {
+                continue;
+            }
+            const SatelliteType& type = satellite_types[it->second];
+            long long data = 0;
+            for (const auto& [segment, transmit] : segments) {
+                data += transmit ? -segment.Length() * type.freeing_speed : segment.Length() * type.filling_speed;
+                maps_total_data += transmit ? segment.Length() * type.freeing_speed : 0;
+                assert(0 <= data && data <= type.space * 1000);
+            }
+        }
+    });
+    assert(maps_total_data == result.total_data);
+
+    // Every copy breaks a single constraint, which has to be reported.
+    auto expect = [&](const TransmissionResult& broken, ScheduleVerifier::ViolationType type) {
+        ScheduleVerifier::Report broken_report = verifier.Verify(broken);
+        bool found = std::any_of(broken_report.violations.begin(), broken_report.violations.end(),
+            [&](const ScheduleVerifier::Violation& violation) { return violation.type == type; })
+            && verifier.Verify(broken, &pool).violations.size() == broken_report.violations.size();
+        assert(found);
+        return found;
+    };
+    int satellite = 0;
+    while (result.shooting_segments[satellite].size() < 2) {
+        satellite++;
+    }
+    int facility = 0;
+    while (result.transmission_segments[facility][satellite].empty()) {
+        facility++;
+    }
+    bool all_found = true;
+    {
+        TransmissionResult broken = result;
+        broken.shooting_segments[satellite][0].l -= 1000000000;
+        all_found &= expect(broken, ScheduleVerifier::ViolationType::OUTSIDE_VISIBILITY);
+    }
+    {
+        TransmissionResult broken = result;
+        broken.shooting_segments[satellite][0].r = broken.shooting_segments[satellite][1].l + 1;
+        all_found &= expect(broken, ScheduleVerifier::ViolationType::SATELLITE_OVERLAP);
+    }
+    {
+        TransmissionResult broken = result;
+        const Segment segment = broken.transmission_segments[facility][satellite][0];
+        broken.transmission_segments[facility][satellite == 0 ? 1 : 0].push_back(segment);
+        all_found &= expect(broken, ScheduleVerifier::ViolationType::FACILITY_OVERLAP);
+    }
+    {
+        TransmissionResult broken = result;
+        broken.shooting_segments[satellite].clear();
+        all_found &= expect(broken, ScheduleVerifier::ViolationType::DISK_UNDERFLOW);
+    }
+    {
+        TransmissionResult broken = result;
+        for (int i = 0; i < visibility.Facilities(); i++) {
+            broken.transmission_segments[i][satellite].clear();
+        }
+        all_found &= expect(broken, ScheduleVerifier::ViolationType::DISK_OVERFLOW);
+    }
+    {
+        TransmissionResult broken = result;
+        broken.total_data++;
+        all_found &= expect(broken, ScheduleVerifier::ViolationType::TOTAL_DATA_MISMATCH);
+    }
+    std::cout << "Schedule verification:\n"
+        << "  maps and binary search: " << maps_time << "ms\n"
+        << "  ScheduleVerifier:       " << sweep_time << "ms\n"
+        << "  ScheduleVerifier, " << pool.Size() << " threads: " << parallel_time << "ms\n"
+        << "  broken copies reported: " << (all_found ? "yes" : "no") << "\n";
+}
+
+}
+
+// Microbenchmarks for the hot parts of the pipeline.
+// Should be run from the `src` directory, the same as `solution`.
+int main() {
+    json config = Reader::ReadConfig("config.json");
+    const int RUNS = 3;
+    BenchmarkReader(config["facility_path"], RUNS);
+    BenchmarkParallelReader(config["facility_path"], RUNS);
+    BenchmarkTimeParse(RUNS);
+    BenchmarkTimeFormat(RUNS);
+    BenchmarkVisibilityCache(config["visibility_cache_path"], config["facility_path"], 
+        config["satellite_path"], RUNS);
+
+    std::vector<SatelliteType> satellites_config;
+    for (auto& satellite : config["satellites"]) {
+        satellites_config.push_back(SatelliteType((int) satellites_config.size(), 
+            satellite["name"], satellite["name_regex"], satellite["filling_speed"],
+            satellite["freeing_speed"], satellite["space"]));
+    }
+    Visibility visibility = VisibilityCache::Load(config["visibility_cache_path"], 
+        config["facility_path"], config["satellite_path"]);
+    std::vector<SatelliteType> satellite_types;
+    for (const auto& name : visibility.satellite_names) {
+        for (const auto& satellite_type : satellites_config) {
+            if (std::regex_match(name, std::regex(satellite_type.name_regex))) {
+                satellite_types.push_back(satellite_type);
+            }
+        }
+    }
+    BenchmarkEvents(visibility);
+    BenchmarkMatching(visibility, satellite_types);
+    BenchmarkActionLog(visibility, satellite_types);
+    BenchmarkQuantizedStepping(visibility, satellite_types);
+    BenchmarkWindows(visibility, satellite_types);
+    BenchmarkFlowGap(visibility, satellite_types);
+    BenchmarkMaxBounds(visibility, satellite_types);
+    BenchmarkScheduleSink(visibility, satellite_types);
+    BenchmarkWriter(visibility, satellite_types);
+    BenchmarkScheduleVerifier(visibility, satellite_types, RUNS);
+    return 0;
+}
@@ -0,0 +1,67 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <condition_variable>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <queue>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "lib/json.hpp"
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+#include "Utils.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+#include "Time.h"
+#include "Segment.h"
+#include "VisibilityStore.h"
+#include "SatelliteType.h"
+#include "Reader.h"
+#include "Visibility.h"
+#include "VisibilityCache.h"
+#include "ScheduleFile.h"
+#include "Writer.h"
+
+// Renders the binary schedule (see `ScheduleFile`) into the text files of the required layout.
+// Usage: `exporter [schedule file] [output directory]`, both default to the files
+// inside `schedule_path` from `config.json`. Should be run from the `src` directory.
+int main(int argc, char** argv) {
+    auto start_time = std::chrono::steady_clock::now();
+    ThreadPool pool;
+    json config = Reader::ReadConfig("config.json");
+    std::string directory = argc > 2 ? argv[2] : std::string(config["schedule_path"]);
+    std::string filename = argc > 1 ? argv[1] : std::string(config["schedule_path"]) + ScheduleFile::FILENAME;
+    Schedule schedule;
+    if (!ScheduleFile::Read(filename, schedule)) {
+        std::cerr << "Unable to read binary schedule from " << filename << "\n";
+        return 1;
+    }
+    Writer::WriteSchedule(directory, schedule.transmission_segments, schedule.shooting_segments,
+        schedule.facility_names, schedule.satellite_names, schedule.satellite_types, &pool);
+    std::cerr << "Total execution time: " << since(start_time).count() << "ms" << std::endl;
+    return 0;
+}
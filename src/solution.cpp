@@ -1,13 +1,33 @@
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
 #include <chrono>
 #include <climits>
 #include <cmath>
+#include <cstdint>
+#include <condition_variable>
+#include <cstring>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <regex>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
+#include <memory>
+#include <numeric>
+#include <queue>
+#include <random>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "lib/json.hpp"
 
@@ -15,20 +35,40 @@ namespace fs = std::filesystem;
 using json = nlohmann::json;
 
 #include "Utils.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
 #include "Time.h"
 #include "Segment.h"
+#include "VisibilityStore.h"
 #include "SatelliteType.h"
 #include "Reader.h"
+#include "Visibility.h"
+#include "VisibilityCache.h"
+#include "ScheduleFile.h"
 #include "Writer.h"
+#include "ActionLog.h"
 #include "TransmissionResult.h"
 #include "Solver.h"
+#include "ScheduleSink.h"
+#include "ScheduleVerifier.h"
+#include "BitsetMatching.h"
+#include "FlowNetwork.h"
 #include "TheoreticalMaxSolver.h"
+#include "TimeExpandedFlowSolver.h"
 #include "GreedyQuantizedTimeSolver.h"
+#include "EventStream.h"
+#include "ActiveEdges.h"
+#include "IncrementalMatching.h"
 #include "GreedyEventBasedSolver.h"
+#include "LocalSearchDriver.h"
+#include "WindowedSolver.h"
 
 int main() {
     auto start_time = std::chrono::steady_clock::now();
 
+    // Thread pool shared by all parallel parts of the pipeline.
+    ThreadPool pool;
+
     // Reads config.
     json config = Reader::ReadConfig("config.json");
     std::vector<SatelliteType> satellites_config;
@@ -38,95 +78,134 @@ int main() {
             satellite["freeing_speed"], satellite["space"]));
     }
 
-    // Reads and creates all information about satellites.
-    // Note that all names are stored separately, 
-    // we operate with indexed entities to make all operations faster.
-    std::map<std::string, std::vector<Segment>> satellite_visibility_map 
-        = Reader::ReadSatelliteVisibility(config["satellite_path"]);
-    int satellites = 0;
-    std::vector<std::string> satellite_names;
-    std::map<std::string, int> satellite_names_map;
-    std::vector<std::vector<Segment>> satellite_visibility;
+    // Reads and creates all information about satellites, facilities and 
+    // facility-satellite visibility segments. 
+    // Uses precompiled visibility cache if it's up to date with the input files.
+    Visibility visibility = VisibilityCache::Load(config["visibility_cache_path"], 
+        config["facility_path"], config["satellite_path"], &pool);
+    std::cerr << "Input reading time: " << since(start_time).count() << "ms" << std::endl;
+    const std::vector<std::string>& satellite_names = visibility.satellite_names;
+    const std::vector<std::string>& facility_names = visibility.facility_names;
     std::vector<SatelliteType> satellite_types;
-    for (const auto& [name, segments] : satellite_visibility_map) {
-        satellite_visibility.push_back(segments);
-        satellite_names.push_back(name);
-        satellite_names_map[name] = satellites++;
+    for (const auto& name : satellite_names) {
         for (const auto& satellite_type : satellites_config) {
             if (std::regex_match(name, std::regex(satellite_type.name_regex))) {
                 satellite_types.push_back(satellite_type);
             }
         }
     }
-    
-    // Reads and creates all information about facilities and facility-satellite visibility segments.
-    // Note that all names are stored separately, 
-    // we operate with indexed entities to make all operations faster.
-    std::map<std::string, std::map<std::string, std::vector<Segment>>> facility_visibility_map 
-        = Reader::ReadFacilityVisibility(config["facility_path"]);
-    int facilities = 0;
-    std::vector<std::string> facility_names;
-    std::map<std::string, int> facility_names_map;
-    std::vector<std::vector<std::vector<Segment>>> facility_visibility;
-    for (const auto& [name, satellites_segments] : facility_visibility_map) {
-        std::vector<std::vector<Segment>> segments(satellites);
-        for (const auto& [satellite, satellite_segments] : satellites_segments) {
-            segments[satellite_names_map[satellite]] = satellite_segments;
-        }
-        facility_visibility.push_back(segments);
-        facility_names.push_back(name);
-        facility_names_map[name] = facilities++;
-    }
 
     // Runs theoretical maximum calculator.
     TheoreticalMaxSolver max_solver;
-    TransmissionResult max_result = max_solver.GetTransmissionSchedule(facility_visibility, 
-        satellite_visibility, satellite_types, {});
+    TransmissionResult max_result = max_solver.GetTransmissionSchedule(visibility.store, 
+        satellite_types);
 
     // Runs main greedy solution algorithm.
     /*
     GreedyQuantizedTimeSolver greedy_quantized_time_solver;
     TransmissionResult greedy_result = greedy_quantized_time_solver.GetTransmissionSchedule(
-        facility_visibility, satellite_visibility, satellite_types, {});
+        visibility.store, satellite_types);
     cerr << "Theoretical maximum: " << max_result.total_data << "\n";
     cerr << "Achieved maximum: " << greedy_result.total_data << "\n";
     */
 
     auto solution_start_time = std::chrono::steady_clock::now();
 
-    GreedyEventBasedSolver greedy_event_based_solver;
-    TransmissionResult greedy_result = greedy_event_based_solver.GetTransmissionSchedule(
-        facility_visibility, satellite_visibility, satellite_types, {});
+    // The horizon could be split into time windows solved in parallel, see `WindowedSolver`.
+    // Enabled by `time_windows.count` in config (1 stands for the sequential solving).
+    WindowedSolverOptions windowed_options;
+    windowed_options.windows = 1;
+    if (config.contains("time_windows")) {
+        windowed_options.windows = config["time_windows"].value("count", 1);
+        windowed_options.overlap = config["time_windows"].value("overlap", windowed_options.overlap);
+    }
+    std::string schedule_format = config.value("schedule_format", "text");
+    bool local_search = config.contains("local_search") && config["local_search"].value("batches", 0) > 0;
+    // The schedule could be encoded into the binary file right during solving instead of being kept
+    // in memory, see `ScheduleFileSink`. Enabled by `stream_schedule` in config, supported only
+    // by the sequential solving with `binary` format and without the local search.
+    bool stream_schedule = config.value("stream_schedule", false);
+    if (stream_schedule && (schedule_format != "binary" || windowed_options.windows != 1 || local_search)) {
+        std::cerr << "stream_schedule requires binary schedule_format, a single time window "
+            << "and no local search, the schedule is kept in memory" << std::endl;
+        stream_schedule = false;
+    }
+    TransmissionResult greedy_result(0, 0);
+    if (stream_schedule) {
+        std::string schedule_path = config["schedule_path"];
+        fs::create_directory(schedule_path);
+        ScheduleFileSink sink(schedule_path + ScheduleFile::FILENAME,
+            facility_names, satellite_names, satellite_types);
+        GreedyEventBasedSolverOptions solver_options;
+        solver_options.record_actions = false;
+        GreedyEventBasedSolver greedy_solver(GreedyEventBasedSolver::Matching::KUHN, solver_options, &sink);
+        greedy_result = greedy_solver.GetTransmissionSchedule(visibility.store, satellite_types);
+    } else {
+        WindowedSolver greedy_solver(pool, []() { return std::make_unique<GreedyEventBasedSolver>(); },
+            windowed_options);
+        greedy_result = greedy_solver.GetTransmissionSchedule(visibility.store, satellite_types);
+    }
     std::cout << "Theoretical maximum: " << max_result.total_data / 1000 << "." 
         << ToStringWithLength(max_result.total_data % 1000, 3) << " MiB\n";
     std::cout << "Achieved maximum: " << greedy_result.total_data / 1000 << "." 
         << ToStringWithLength(greedy_result.total_data % 1000, 3) << " MiB\n";
     std::cerr << "Solution execution time: " << since(solution_start_time).count() << "ms" << std::endl;
 
-
-    // TODO: Add verifier
+    // Checks the schedule in memory after every solving step, found violations are printed
+    // but don't prevent writing the schedule, so it still could be examined.
+    // The streamed schedule isn't kept in memory, so it could be checked only by `verifier`.
+    ScheduleVerifier verifier(visibility.store, satellite_types);
+    auto verify = [&](const TransmissionResult& result) {
+        if (stream_schedule) {
+            std::cerr << "Verification: skipped for the streamed schedule" << std::endl;
+            return;
+        }
+        auto verification_start_time = std::chrono::steady_clock::now();
+        ScheduleVerifier::Report report = verifier.Verify(result, &pool);
+        std::cerr << "Verification: " << (report.Ok() ? "OK" : std::to_string(report.violations.size()) 
+            + " violations") << ", " << since(verification_start_time).count() << "ms" << std::endl;
+        for (int k = 0; k < std::min((int) report.violations.size(), 10); k++) {
+            const auto& violation = report.violations[k];
+            std::cerr << "  " << ScheduleVerifier::TypeName(violation.type)
+                << (violation.facility == -1 ? "" : " " + facility_names[violation.facility])
+                << (violation.satellite == -1 ? "" : " " + satellite_names[violation.satellite])
+                << " [" << violation.segment.l << ", " << violation.segment.r << "): " << violation.value << "\n";
+        }
+    };
+    verify(greedy_result);
 
     // Optional part that allows to iteratively improve previously achieved results.
     // Note that improvement is very minor but could significantly increase the calculation time.
-    // Use with caution. 
-    
-    /*
-    int iterations = (int) greedy_result.actions.size();
-    const int BATCHES = 300;
-    int batch_size = iterations / BATCHES;
-    for (int i = 0; i < BATCHES; i++) {
-        TransmissionResult optimized_result = greedy_event_based_solver.GetTransmissionSchedule(facility_visibility, 
-            satellite_visibility, satellite_types, greedy_result.actions, i * batch_size + rand() % batch_size);
-        if (optimized_result.total_data > greedy_result.total_data) {
-            greedy_result = optimized_result;
+    // Use with caution, enabled by `local_search.batches` in config.
+    if (local_search) {
+        auto local_search_start_time = std::chrono::steady_clock::now();
+        const json& local_search_config = config["local_search"];
+        LocalSearchOptions options;
+        options.batches = local_search_config["batches"];
+        options.round_size = local_search_config.value("round_size", options.round_size);
+        options.seed = local_search_config.value("seed", 0ULL);
+        if (local_search_config.value("acceptance", "improvement") == "threshold") {
+            options.acceptance = LocalSearchOptions::Acceptance::THRESHOLD;
+            options.threshold = local_search_config.value("threshold", 0LL);
         }
-        std::cerr << "Currently achieved maximum (BATCH #" << i + 1 << "/" << BATCHES << "): " << greedy_result.total_data << "\n"; 
+        options.verify = local_search_config.value("verify", false);
+        LocalSearchDriver driver(pool, []() { return std::make_unique<GreedyEventBasedSolver>(); }, options);
+        greedy_result = driver.Run(visibility.store, satellite_types, std::move(greedy_result));
+        std::cerr << "Local search execution time: " << since(local_search_start_time).count() << "ms" << std::endl;
+        verify(greedy_result);
     }
-    */
 
-    // Writes the calculated schedule to the output file.
-    Writer::WriteSchedule(config["schedule_path"], greedy_result.transmission_segments, 
-        greedy_result.shooting_segments, facility_names, satellite_names, satellite_types);
+    // Writes the calculated schedule to the output files: text files of the required layout
+    // and / or the compact binary file, chosen by `schedule_format` in config.
+    // The streamed schedule is already written by the sink.
+    if (schedule_format != "binary") {
+        Writer::WriteSchedule(config["schedule_path"], greedy_result.transmission_segments, 
+            greedy_result.shooting_segments, facility_names, satellite_names, satellite_types, &pool);
+    }
+    if (schedule_format != "text" && !stream_schedule) {
+        Writer::WriteBinarySchedule(config["schedule_path"], greedy_result.transmission_segments,
+            greedy_result.shooting_segments, facility_names, satellite_names, satellite_types);
+    }
 
     std::cerr << "Total execution time: " << since(start_time).count() << "ms" << std::endl;
 
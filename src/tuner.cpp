@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <condition_variable>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <queue>
+#include <random>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "lib/json.hpp"
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+#include "Utils.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+#include "Time.h"
+#include "Segment.h"
+#include "VisibilityStore.h"
+#include "SatelliteType.h"
+#include "Reader.h"
+#include "Visibility.h"
+#include "VisibilityCache.h"
+#include "ScheduleFile.h"
+#include "ActionLog.h"
+#include "TransmissionResult.h"
+#include "Solver.h"
+#include "ScheduleSink.h"
+#include "ScheduleVerifier.h"
+#include "BitsetMatching.h"
+#include "GreedyQuantizedTimeSolver.h"
+#include "EventStream.h"
+#include "ActiveEdges.h"
+#include "IncrementalMatching.h"
+#include "GreedyEventBasedSolver.h"
+#include "SolverTuner.h"
+
+// Searches for the best parameters of the greedy solver, see `SolverTuner`.
+// Reads the visibility data and `tuning` section from `config.json`,
+// should be run from the `src` directory, the same as `solution`.
+int main() {
+    auto start_time = std::chrono::steady_clock::now();
+    ThreadPool pool;
+    json config = Reader::ReadConfig("config.json");
+    std::vector<SatelliteType> satellites_config;
+    for (auto& satellite : config["satellites"]) {
+        satellites_config.push_back(SatelliteType((int) satellites_config.size(),
+            satellite["name"], satellite["name_regex"], satellite["filling_speed"],
+            satellite["freeing_speed"], satellite["space"]));
+    }
+    Visibility visibility = VisibilityCache::Load(config["visibility_cache_path"],
+        config["facility_path"], config["satellite_path"], &pool);
+    std::vector<SatelliteType> satellite_types;
+    for (const auto& name : visibility.satellite_names) {
+        for (const auto& satellite_type : satellites_config) {
+            if (std::regex_match(name, std::regex(satellite_type.name_regex))) {
+                satellite_types.push_back(satellite_type);
+            }
+        }
+    }
+
+    SolverTuningOptions options;
+    if (config.contains("tuning")) {
+        const json& tuning_config = config["tuning"];
+        options.solver = tuning_config.value("solver", options.solver);
+        if (tuning_config.value("search", "grid") == "random") {
+            options.search = SolverTuningOptions::Search::RANDOM;
+        }
+        options.samples = tuning_config.value("samples", options.samples);
+        options.seed = tuning_config.value("seed", options.seed);
+        if (tuning_config.contains("parameters")) {
+            for (const auto& [name, values] : tuning_config["parameters"].items()) {
+                options.parameters[name] = values.get<std::vector<double>>();
+            }
+        }
+    }
+    // The config is edited by hand, so mistakes are reported instead of being asserted in the tuner.
+    std::vector<std::string> parameter_names = SolverTuner::ParameterNames(options.solver);
+    if (parameter_names.empty()) {
+        std::cerr << "Unknown solver \"" << options.solver << "\" in tuning config, "
+            << "expected \"event\" or \"quantized\"\n";
+        return 1;
+    }
+    for (const auto& [name, values] : options.parameters) {
+        if (find(parameter_names.begin(), parameter_names.end(), name) == parameter_names.end()) {
+            std::cerr << "Unknown parameter \"" << name << "\" of the " << options.solver
+                << " solver, expected one of:";
+            for (const auto& parameter_name : parameter_names) {
+                std::cerr << " " << parameter_name;
+            }
+            std::cerr << "\n";
+            return 1;
+        }
+        if (values.empty()) {
+            std::cerr << "No candidate values of the parameter \"" << name << "\"\n";
+            return 1;
+        }
+    }
+    SolverTuner tuner(pool, options);
+    std::vector<SolverTuner::Configuration> configurations = tuner.Run(visibility.store, satellite_types);
+
+    const SolverTuner::Configuration* best = nullptr;
+    for (const auto& configuration : configurations) {
+        for (const auto& [name, value] : configuration.parameters) {
+            std::cout << name << " = " << value << ", ";
+        }
+        std::cout << "total data: " << configuration.total_data / 1000 << "."
+            << ToStringWithLength(configuration.total_data % 1000, 3) << " MiB, "
+            << configuration.time << "ms\n";
+        if (best == nullptr || configuration.total_data > best->total_data) {
+            best = &configuration;
+        }
+    }
+    if (best != nullptr) {
+        std::cout << "Best configuration:";
+        for (const auto& [name, value] : best->parameters) {
+            std::cout << " " << name << " = " << value;
+        }
+        std::cout << "\n";
+    }
+    std::cerr << "Total execution time: " << since(start_time).count() << "ms" << std::endl;
+    return 0;
+}
@@ -1,13 +1,29 @@
 #include <algorithm>
+#include <atomic>
+#include <cerrno>
 #include <chrono>
 #include <climits>
 #include <cmath>
+#include <cstdint>
+#include <condition_variable>
+#include <cstring>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <regex>
+#include <set>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
+#include <mutex>
+#include <queue>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "lib/json.hpp"
 
@@ -15,13 +31,27 @@ namespace fs = std::filesystem;
 using json = nlohmann::json;
 
 #include "Utils.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
 #include "Time.h"
 #include "Segment.h"
+#include "VisibilityStore.h"
 #include "Reader.h"
+#include "Visibility.h"
+#include "VisibilityCache.h"
 #include "ResultsReader.h"
 #include "SatelliteType.h"
+#include "ScheduleFile.h"
+#include "ActionLog.h"
+#include "TransmissionResult.h"
+#include "ScheduleVerifier.h"
 
 int main() {
+    auto start_time = std::chrono::steady_clock::now();
+
+    // Thread pool shared by all parallel parts of the pipeline.
+    ThreadPool pool;
+
     // Reads config.
     json config = Reader::ReadConfig("config.json");
     std::vector<SatelliteType> satellites_config;
@@ -31,119 +61,122 @@ int main() {
             satellite["freeing_speed"], satellite["space"]));
     }
 
-    // Reads and creates all information about satellites.
-    // Note that all names are stored separately, 
-    // we operate with indexed entities to make all operations faster.
-    std::map<std::string, std::vector<Segment>> satellite_visibility_map 
-        = Reader::ReadSatelliteVisibility(config["satellite_path"]);
-    int satellites = 0;
-    std::vector<std::string> satellite_names;
+    // Reads and creates all information about satellites, facilities and 
+    // facility-satellite visibility segments. 
+    // Uses precompiled visibility cache if it's up to date with the input files.
+    Visibility visibility = VisibilityCache::Load(config["visibility_cache_path"], 
+        config["facility_path"], config["satellite_path"], &pool);
+    const std::vector<std::string>& satellite_names = visibility.satellite_names;
+    const std::vector<std::string>& facility_names = visibility.facility_names;
     std::map<std::string, int> satellite_names_map;
-    std::vector<std::vector<Segment>> satellite_visibility;
     std::vector<SatelliteType> satellite_types;
-    for (const auto& [name, segments] : satellite_visibility_map) {
-        satellite_visibility.push_back(segments);
-        satellite_names.push_back(name);
-        satellite_names_map[name] = satellites++;
+    for (int i = 0; i < visibility.Satellites(); i++) {
+        satellite_names_map[satellite_names[i]] = i;
         for (const auto& satellite_type : satellites_config) {
-            if (std::regex_match(name, std::regex(satellite_type.name_regex))) {
+            if (std::regex_match(satellite_names[i], std::regex(satellite_type.name_regex))) {
                 satellite_types.push_back(satellite_type);
             }
         }
     }
-    
-    // Reads and creates all information about facilities and facility-satellite visibility segments.
-    // Note that all names are stored separately, 
-    // we operate with indexed entities to make all operations faster.
-    std::map<std::string, std::map<std::string, std::vector<Segment>>> facility_visibility_map 
-        = Reader::ReadFacilityVisibility(config["facility_path"]);
-    int facilities = 0;
-    std::vector<std::string> facility_names;
     std::map<std::string, int> facility_names_map;
-    std::vector<std::vector<std::vector<Segment>>> facility_visibility;
-    for (const auto& [name, satellites_segments] : facility_visibility_map) {
-        std::vector<std::vector<Segment>> segments(satellites);
-        for (const auto& [satellite, satellite_segments] : satellites_segments) {
-            segments[satellite_names_map[satellite]] = satellite_segments;
-        }
-        facility_visibility.push_back(segments);
-        facility_names.push_back(name);
-        facility_names_map[name] = facilities++;
+    for (int i = 0; i < visibility.Facilities(); i++) {
+        facility_names_map[visibility.facility_names[i]] = i;
     }
 
-    // Reads all outputted results about transmitted data segments.
-    std::map<std::string, std::map<std::string, std::vector<Segment>>> transmission_segments 
-        = ResultsReader::ReadDropFiles(std::string(config["schedule_path"]) + "Drop/");
-    // Reads all outputted results about photoshotting segments.
-    std::map<std::string, std::vector<Segment>> shooting_segments 
-        = ResultsReader::ReadCameraFiles(std::string(config["schedule_path"]) + "Camera/");
-
-    // Stores all segments for given entity (facility or satellite).
-    // Stores 1 as second element of pair if the segment corresponds to data transmission.
-    // Stores 0 if the segment corresponds to photoshooting.
-    std::map<std::string, std::vector<std::pair<Segment, int>>> action_segments;
-    for (const auto& [facility, satellite_segments] : transmission_segments) {
-        for (const auto& [satellite, segments] : satellite_segments) {
-            const auto& visibility_segments = facility_visibility_map[facility][satellite];
-            for (const auto& segment : segments) {
-                action_segments[facility].push_back(std::make_pair(segment, 1));
-                action_segments[satellite].push_back(std::make_pair(segment, 1));
-
-                // Check that visibility segments contain outputted segment.
-                auto it = lower_bound(visibility_segments.begin(), visibility_segments.end(), Segment(segment.l + 1, segment.l));
-                assert(it != visibility_segments.begin());
-                it--;
-                assert(it->l <= segment.l && segment.r <= it->r);
+    // Names are interned once per segment list, all checks work with the indices afterwards.
+    // Lists of the names which are absent in the visibility data can't be checked, they are only reported.
+    TransmissionResult result(visibility.Facilities(), visibility.Satellites());
+    std::set<std::string> unknown_names;
+    auto add_transmissions = [&](const std::string& facility, const std::string& satellite,
+        std::vector<Segment> segments) {
+        auto facility_it = facility_names_map.find(facility);
+        auto satellite_it = satellite_names_map.find(satellite);
+        if (facility_it == facility_names_map.end() || satellite_it == satellite_names_map.end()) {
+            unknown_names.insert(facility_it == facility_names_map.end() ? facility : satellite);
+            return;
+        }
+        result.transmission_segments[facility_it->second][satellite_it->second] = std::move(segments);
+    };
+    auto add_shootings = [&](const std::string& satellite, std::vector<Segment> segments) {
+        auto satellite_it = satellite_names_map.find(satellite);
+        if (satellite_it == satellite_names_map.end()) {
+            unknown_names.insert(satellite);
+            return;
+        }
+        result.shooting_segments[satellite_it->second] = std::move(segments);
+    };
+    if (config.value("schedule_format", "text") != "text") {
+        // Reads the binary schedule instead of parsing the text files. Text files aren't written
+        // with `binary` format and could be left from the previous run, so they are never used instead.
+        std::string filename = std::string(config["schedule_path"]) + ScheduleFile::FILENAME;
+        Schedule schedule;
+        if (!ScheduleFile::Read(filename, schedule)) {
+            std::cerr << "Unable to read binary schedule from " << filename << "\n";
+            return 1;
+        }
+        for (int i = 0; i < (int) schedule.facility_names.size(); i++) {
+            for (int j = 0; j < (int) schedule.satellite_names.size(); j++) {
+                if (!schedule.transmission_segments[i][j].empty()) {
+                    add_transmissions(schedule.facility_names[i], schedule.satellite_names[j],
+                        std::move(schedule.transmission_segments[i][j]));
+                }
             }
         }
-    }
-    for (const auto& [satellite, segments] : shooting_segments) {
-        const auto& visibility_segments = satellite_visibility_map[satellite];
-        for (const auto& segment : segments) {
-            action_segments[satellite].push_back(std::make_pair(segment, 0));
-
-            // Check that visibility segments contain outputted segment.
-            auto it = lower_bound(visibility_segments.begin(), visibility_segments.end(), Segment(segment.l + 1, segment.l));
-            assert(it != visibility_segments.begin());
-            it--;
-            assert(it->l <= segment.l && segment.r <= it->r);
+        for (int j = 0; j < (int) schedule.satellite_names.size(); j++) {
+            add_shootings(schedule.satellite_names[j], std::move(schedule.shooting_segments[j]));
         }
-    }
-
-    std::vector<long long> data(satellite_names.size());
-    long long total_data = 0;
-    for (const auto& [name, segments] : action_segments) {
-        std::vector<std::pair<Segment, int>> sorted_segments = segments;
-        sort(sorted_segments.begin(), sorted_segments.end());
-        for (int i = 1; i < (int) sorted_segments.size(); i++) {
-            // Check that no two segments with some action (data transmission or photoshooting) 
-            // intersect with each other.
-            if (sorted_segments[i].first.Intersects(sorted_segments[i + 1].first)) {
-                std::cerr << name << " " << sorted_segments[i].first.l << " " << sorted_segments[i].first.r 
-                << " " << sorted_segments[i + 1].first.l << sorted_segments[i + 1].first.r << "\n";
+    } else {
+        // Reads all outputted results about transmitted data segments.
+        for (auto& [facility, satellite_segments] : ResultsReader::ReadDropFiles(
+            std::string(config["schedule_path"]) + "Drop/", &pool)) {
+            for (auto& [satellite, segments] : satellite_segments) {
+                add_transmissions(facility, satellite, std::move(segments));
             }
-            assert(!sorted_segments[i].first.Intersects(sorted_segments[i + 1].first));
         }
-        if (!satellite_names_map.count(name)) {
-            continue;
+        // Reads all outputted results about photoshotting segments.
+        for (auto& [satellite, segments] : ResultsReader::ReadCameraFiles(
+            std::string(config["schedule_path"]) + "Camera/", &pool)) {
+            add_shootings(satellite, std::move(segments));
         }
-        int ind = satellite_names_map[name];
-        for (auto& [segment, transmit] : sorted_segments) {
-            if (!transmit) {
-                data[ind] += segment.Length() * satellite_types[ind].filling_speed;
-                // Check that we never exceed disk space.
-                assert(data[ind] <= satellite_types[ind].space * 1000);
-            } else {
-                long long current_data = segment.Length() * satellite_types[ind].freeing_speed;
-                data[ind] -= current_data;
-                total_data += current_data;
-                // Check that we never try to transmit more than we have.
-                assert(data[ind] >= 0);
+    }
+    // Output files don't store the total amount of data, so it's taken from the transmissions themselves.
+    for (int i = 0; i < visibility.Facilities(); i++) {
+        for (int j = 0; j < visibility.Satellites(); j++) {
+            for (const auto& segment : result.transmission_segments[i][j]) {
+                result.total_data += segment.Length() * satellite_types[j].freeing_speed;
             }
         }
     }
-    std::cout << "Total transmitted data: " << total_data / 1000 << "." 
-        << ToStringWithLength(total_data % 1000, 3) << " MiB\n";
+    std::cerr << "Schedule reading time: " << since(start_time).count() << "ms" << std::endl;
+
+    // Checks every satellite and facility in parallel and collects all violations
+    // instead of stopping at the first one.
+    auto verification_start_time = std::chrono::steady_clock::now();
+    ScheduleVerifier verifier(visibility.store, satellite_types);
+    ScheduleVerifier::Report report = verifier.Verify(result, &pool);
+    std::cerr << "Verification time: " << since(verification_start_time).count() << "ms" << std::endl;
+
+    // Writes the full report to the file and its summary to the output.
+    json report_json = ScheduleVerifier::ToJson(report, facility_names, satellite_names);
+    report_json["unknown_names"] = unknown_names;
+    report_json["valid"] = report.Ok() && unknown_names.empty();
+    std::string report_path = config.value("verification_report_path", "../Results/verification.json");
+    fs::create_directories(fs::path(report_path).parent_path());
+    std::ofstream(report_path) << report_json.dump(2) << "\n";
+
+    std::cout << "Total transmitted data: " << report.total_data / 1000 << "." 
+        << ToStringWithLength(report.total_data % 1000, 3) << " MiB\n";
+    for (const auto& [type, count] : report_json["summary"].items()) {
+        if (count.get<long long>() > 0) {
+            std::cout << "  " << type << ": " << count.get<long long>() << "\n";
+        }
+    }
+    for (const auto& name : unknown_names) {
+        std::cout << "  unknown name: " << name << "\n";
+    }
+    std::cout << (report_json["valid"].get<bool>() ? "Schedule is valid" : "Schedule is invalid")
+        << ", the report is written to " << report_path << "\n";
+    std::cerr << "Total execution time: " << since(start_time).count() << "ms" << std::endl;
 
-    return 0;
-}
\ No newline at end of file
+    return report_json["valid"].get<bool>() ? 0 : 1;
+}